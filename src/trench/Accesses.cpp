@@ -0,0 +1,333 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#include "Accesses.h"
+
+#include <algorithm>
+#include <cassert>
+#include <deque>
+#include <tuple>
+
+#include "Census.h"
+#include "Program.h"
+#include "State.h"
+#include "Transition.h"
+
+namespace trench {
+
+void AccessSet::addRead(std::size_t variable, std::size_t space) {
+	set(reads_, variable);
+	readSpaces_ |= uint64_t(1) << space;
+}
+
+void AccessSet::addWrite(std::size_t variable, std::size_t space) {
+	set(writes_, variable);
+	writeSpaces_ |= uint64_t(1) << space;
+}
+
+void AccessSet::addReadAnywhere(std::size_t space) {
+	readSpaces_ |= uint64_t(1) << space;
+	readAnywhere_ |= uint64_t(1) << space;
+}
+
+void AccessSet::addWriteAnywhere(std::size_t space) {
+	writeSpaces_ |= uint64_t(1) << space;
+	writeAnywhere_ |= uint64_t(1) << space;
+}
+
+void AccessSet::addLockRead(std::size_t variable) {
+	set(reads_, variable);
+}
+
+void AccessSet::addLockWrite(std::size_t variable) {
+	set(writes_, variable);
+}
+
+bool AccessSet::unite(const AccessSet &that) {
+	bool changed = false;
+	changed |= unite(reads_, that.reads_);
+	changed |= unite(writes_, that.writes_);
+
+	auto old = std::make_tuple(readSpaces_, writeSpaces_, readAnywhere_, writeAnywhere_);
+	readSpaces_    |= that.readSpaces_;
+	writeSpaces_   |= that.writeSpaces_;
+	readAnywhere_  |= that.readAnywhere_;
+	writeAnywhere_ |= that.writeAnywhere_;
+
+	return changed || old != std::make_tuple(readSpaces_, writeSpaces_, readAnywhere_, writeAnywhere_);
+}
+
+bool AccessSet::conflictsWith(const AccessSet &that) const {
+	return
+		intersect(writes_, that.reads_) ||
+		intersect(writes_, that.writes_) ||
+		intersect(reads_, that.writes_) ||
+		(writeAnywhere_ & (that.readSpaces_ | that.writeSpaces_)) ||
+		(readAnywhere_ & that.writeSpaces_) ||
+		(that.writeAnywhere_ & (readSpaces_ | writeSpaces_)) ||
+		(that.readAnywhere_ & writeSpaces_);
+}
+
+bool AccessSet::mayWrite(std::size_t variable, std::size_t space) const {
+	return test(writes_, variable) || (writeAnywhere_ & (uint64_t(1) << space));
+}
+
+void AccessSet::set(std::vector<uint64_t> &bits, std::size_t index) {
+	if (bits.size() <= index / 64) {
+		bits.resize(index / 64 + 1);
+	}
+	bits[index / 64] |= uint64_t(1) << (index % 64);
+}
+
+bool AccessSet::test(const std::vector<uint64_t> &bits, std::size_t index) {
+	return index / 64 < bits.size() && (bits[index / 64] & (uint64_t(1) << (index % 64)));
+}
+
+bool AccessSet::intersect(const std::vector<uint64_t> &a, const std::vector<uint64_t> &b) {
+	for (std::size_t i = 0, size = std::min(a.size(), b.size()); i < size; ++i) {
+		if (a[i] & b[i]) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool AccessSet::unite(std::vector<uint64_t> &a, const std::vector<uint64_t> &b) {
+	bool changed = false;
+	if (a.size() < b.size()) {
+		a.resize(b.size());
+	}
+	for (std::size_t i = 0; i < b.size(); ++i) {
+		if (b[i] & ~a[i]) {
+			a[i] |= b[i];
+			changed = true;
+		}
+	}
+	return changed;
+}
+
+bool AccessSet::isZero(const std::vector<uint64_t> &bits) {
+	return std::all_of(bits.begin(), bits.end(), [](uint64_t word) { return word == 0; });
+}
+
+namespace {
+
+class AccessCollector {
+	const Census &census_;
+	std::size_t lock_;
+
+public:
+	explicit
+	AccessCollector(const Census &census): census_(census), lock_(census.cells().size()) {}
+
+	/**
+	 * \return Index of the space in the census' spaces. Spaces beyond the 64th share the last index.
+	 */
+	std::size_t getSpaceIndex(Space space) const {
+		const auto &spaces = census_.spaces();
+		std::size_t index = std::lower_bound(spaces.begin(), spaces.end(), space) - spaces.begin();
+		return std::min<std::size_t>(index, 63);
+	}
+
+	void collect(const Instruction &instruction, AccessSet &accesses) const {
+		switch (instruction.mnemonic()) {
+			case Instruction::READ: {
+				auto read = instruction.as<Read>();
+				collect(*read->address(), accesses);
+				addAccess(read->space(), *read->address(), false, accesses);
+				break;
+			}
+			case Instruction::WRITE: {
+				auto write = instruction.as<Write>();
+				collect(*write->value(), accesses);
+				collect(*write->address(), accesses);
+				addAccess(write->space(), *write->address(), true, accesses);
+				break;
+			}
+			case Instruction::LOCAL: {
+				collect(*instruction.as<Local>()->value(), accesses);
+				break;
+			}
+			case Instruction::CONDITION: {
+				collect(*instruction.as<Condition>()->expression(), accesses);
+				break;
+			}
+			case Instruction::ATOMIC: {
+				for (const auto &instr : instruction.as<Atomic>()->instructions()) {
+					collect(*instr, accesses);
+				}
+				break;
+			}
+			case Instruction::LOCK: /* FALLTHROUGH */
+			case Instruction::UNLOCK: {
+				accesses.addLockRead(lock_);
+				accesses.addLockWrite(lock_);
+				break;
+			}
+			case Instruction::MFENCE: /* FALLTHROUGH */
+			case Instruction::NOOP:
+				break;
+			default: {
+				assert(!"NEVER REACHED");
+			}
+		}
+	}
+
+private:
+	void collect(const Expression &expression, AccessSet &accesses) const {
+		if (auto unary = expression.as<UnaryOperator>()) {
+			collect(*unary->operand(), accesses);
+		} else if (auto binary = expression.as<BinaryOperator>()) {
+			collect(*binary->left(), accesses);
+			collect(*binary->right(), accesses);
+		} else if (expression.is<CanAccessMemory>()) {
+			accesses.addLockRead(lock_);
+		}
+	}
+
+	void addAccess(Space space, const Expression &address, bool write, AccessSet &accesses) const {
+		auto spaceIndex = getSpaceIndex(space);
+		std::size_t cell = Census::NO_ID;
+		if (auto constant = address.as<Constant>()) {
+			cell = census_.getCellId(space, constant->value());
+		}
+		if (cell != Census::NO_ID) {
+			if (write) {
+				accesses.addWrite(cell, spaceIndex);
+			} else {
+				accesses.addRead(cell, spaceIndex);
+			}
+		} else {
+			if (write) {
+				accesses.addWriteAnywhere(spaceIndex);
+			} else {
+				accesses.addReadAnywhere(spaceIndex);
+			}
+		}
+	}
+};
+
+} // anonymous namespace
+
+Accesses computeAccesses(const Program &program, const Census &census) {
+	Accesses result;
+	AccessCollector collector(census);
+
+	result.lock_ = census.cells().size();
+
+	auto interestingCell = census.getCellId(program.interestingSpace(), program.interestingAddress());
+	auto interestingSpace = collector.getSpaceIndex(program.interestingSpace());
+
+	auto nthreads = census.threads().size();
+	result.transitionAccesses_.resize(nthreads);
+	result.localAccesses_.resize(nthreads);
+	result.reachableAccesses_.resize(nthreads);
+	result.backEdges_.resize(nthreads);
+	result.visible_.resize(nthreads);
+	result.visibleDistances_.resize(nthreads);
+
+	for (std::size_t thread = 0; thread < nthreads; ++thread) {
+		const auto &states = census.states(thread);
+
+		auto &transitionAccesses = result.transitionAccesses_[thread];
+		auto &localAccesses = result.localAccesses_[thread];
+		auto &reachableAccesses = result.reachableAccesses_[thread];
+		auto &backEdges = result.backEdges_[thread];
+		auto &visible = result.visible_[thread];
+		auto &visibleDistances = result.visibleDistances_[thread];
+
+		transitionAccesses.resize(states.size());
+		localAccesses.resize(states.size());
+		backEdges.resize(states.size());
+		visible.resize(states.size());
+
+		for (std::size_t state = 0; state < states.size(); ++state) {
+			for (const Transition *transition : states[state]->out()) {
+				AccessSet accesses;
+				collector.collect(*transition->instruction(), accesses);
+				localAccesses[state].unite(accesses);
+				visible[state].push_back(accesses.mayWrite(interestingCell, interestingSpace));
+				transitionAccesses[state].push_back(std::move(accesses));
+			}
+			backEdges[state].resize(states[state]->out().size());
+		}
+
+		/* Accesses of reachable transitions: least fixpoint. */
+		reachableAccesses = localAccesses;
+		for (bool changed = true; changed; ) {
+			changed = false;
+			for (std::size_t state = 0; state < states.size(); ++state) {
+				for (const Transition *transition : states[state]->out()) {
+					changed |= reachableAccesses[state].unite(reachableAccesses[census.getId(transition->to())]);
+				}
+			}
+		}
+
+		/* Distances to visible transitions: breadth-first search along reversed transitions. */
+		visibleDistances.assign(states.size(), std::size_t(Accesses::INFINITE_DISTANCE));
+		std::vector<std::vector<std::size_t>> predecessors(states.size());
+		std::deque<std::size_t> queue;
+		for (std::size_t state = 0; state < states.size(); ++state) {
+			const auto &out = states[state]->out();
+			for (std::size_t index = 0; index < out.size(); ++index) {
+				predecessors[census.getId(out[index]->to())].push_back(state);
+				if (visible[state][index] && visibleDistances[state] == Accesses::INFINITE_DISTANCE) {
+					visibleDistances[state] = 1;
+					queue.push_back(state);
+				}
+			}
+		}
+		while (!queue.empty()) {
+			auto state = queue.front();
+			queue.pop_front();
+			for (auto predecessor : predecessors[state]) {
+				if (visibleDistances[predecessor] == Accesses::INFINITE_DISTANCE) {
+					visibleDistances[predecessor] = visibleDistances[state] + 1;
+					queue.push_back(predecessor);
+				}
+			}
+		}
+
+		/* Back edges: edges to states on the stack of a depth-first search. */
+		enum Color { WHITE, GREY, BLACK };
+		std::vector<Color> colors(states.size(), WHITE);
+		std::vector<std::pair<std::size_t, std::size_t>> stack;
+
+		for (std::size_t root = 0; root < states.size(); ++root) {
+			if (colors[root] != WHITE) {
+				continue;
+			}
+			colors[root] = GREY;
+			stack.push_back(std::make_pair(root, 0));
+
+			while (!stack.empty()) {
+				auto state = stack.back().first;
+				auto index = stack.back().second++;
+				const auto &out = states[state]->out();
+
+				if (index < out.size()) {
+					auto to = census.getId(out[index]->to());
+					if (colors[to] == WHITE) {
+						colors[to] = GREY;
+						stack.push_back(std::make_pair(to, 0));
+					} else if (colors[to] == GREY) {
+						backEdges[state][index] = true;
+					}
+				} else {
+					colors[state] = BLACK;
+					stack.pop_back();
+				}
+			}
+		}
+	}
+
+	return result;
+}
+
+} // namespace trench
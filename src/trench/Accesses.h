@@ -0,0 +1,176 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <trench/config.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "Instruction.h"
+
+namespace trench {
+
+class Census;
+class Program;
+
+/**
+ * Set of shared variables read and written by a piece of code.
+ *
+ * Variables are the memory cells with constant addresses, identified by their ids
+ * in a Census, and the memory lock. Accesses at addresses unknown statically
+ * are accounted for as accesses to all the cells of the space.
+ */
+class AccessSet {
+	/** Bits of cells read and written, the cell after the last one being the memory lock. */
+	std::vector<uint64_t> reads_;
+	std::vector<uint64_t> writes_;
+
+	/** Bits of spaces (indexes in census' spaces) accessed at all. */
+	uint64_t readSpaces_;
+	uint64_t writeSpaces_;
+
+	/** Bits of spaces accessed at statically unknown addresses. */
+	uint64_t readAnywhere_;
+	uint64_t writeAnywhere_;
+
+public:
+	AccessSet(): readSpaces_(0), writeSpaces_(0), readAnywhere_(0), writeAnywhere_(0) {}
+
+	void addRead(std::size_t variable, std::size_t space);
+	void addWrite(std::size_t variable, std::size_t space);
+	void addReadAnywhere(std::size_t space);
+	void addWriteAnywhere(std::size_t space);
+
+	/** Accounts for an access to the memory lock, being the given variable. */
+	void addLockRead(std::size_t variable);
+	void addLockWrite(std::size_t variable);
+
+	/**
+	 * Adds all the accesses from the given set.
+	 *
+	 * \return True if the set has changed, false otherwise.
+	 */
+	bool unite(const AccessSet &that);
+
+	/**
+	 * \return True if the two sets access the same variable and at least one of them writes it.
+	 */
+	bool conflictsWith(const AccessSet &that) const;
+
+	/**
+	 * \return True if the set may write the given cell of the given space.
+	 */
+	bool mayWrite(std::size_t variable, std::size_t space) const;
+
+	/**
+	 * \return True if the set writes the memory lock, being the given variable.
+	 */
+	bool writesLock(std::size_t variable) const { return test(writes_, variable); }
+
+	bool empty() const { return !readSpaces_ && !writeSpaces_ && isZero(reads_) && isZero(writes_); }
+
+private:
+	static void set(std::vector<uint64_t> &bits, std::size_t index);
+	static bool test(const std::vector<uint64_t> &bits, std::size_t index);
+	static bool intersect(const std::vector<uint64_t> &a, const std::vector<uint64_t> &b);
+	static bool unite(std::vector<uint64_t> &a, const std::vector<uint64_t> &b);
+	static bool isZero(const std::vector<uint64_t> &bits);
+};
+
+/**
+ * Shared variables accessed by the transitions of each thread.
+ *
+ * Threads and control states are identified by their ids in a Census,
+ * transitions by their indexes in the list of outgoing transitions of their source state.
+ */
+class Accesses {
+	/** Variable standing for the memory lock. */
+	std::size_t lock_;
+
+	/** Accesses of transitions, indexed by thread, state and transition. */
+	std::vector<std::vector<std::vector<AccessSet>>> transitionAccesses_;
+
+	/** Accesses of all the transitions going from a state, indexed by thread and state. */
+	std::vector<std::vector<AccessSet>> localAccesses_;
+
+	/** Accesses of all the transitions reachable from a state, indexed by thread and state. */
+	std::vector<std::vector<AccessSet>> reachableAccesses_;
+
+	/** Whether a transition closes a cycle in its thread, indexed by thread, state and transition. */
+	std::vector<std::vector<std::vector<bool>>> backEdges_;
+
+	/** Whether a transition may write the interesting cell, indexed by thread, state and transition. */
+	std::vector<std::vector<std::vector<bool>>> visible_;
+
+	/** Number of transitions a thread must execute from a state to execute a visible one, indexed by thread and state. */
+	std::vector<std::vector<std::size_t>> visibleDistances_;
+
+	friend Accesses computeAccesses(const Program &program, const Census &census);
+
+public:
+	/** Distance from a state from which no visible transition is reachable. */
+	static const std::size_t INFINITE_DISTANCE = static_cast<std::size_t>(-1);
+
+	Accesses(): lock_(0) {}
+
+	const AccessSet &getTransitionAccesses(std::size_t thread, std::size_t state, std::size_t transition) const {
+		return transitionAccesses_[thread][state][transition];
+	}
+
+	const AccessSet &getLocalAccesses(std::size_t thread, std::size_t state) const {
+		return localAccesses_[thread][state];
+	}
+
+	const AccessSet &getReachableAccesses(std::size_t thread, std::size_t state) const {
+		return reachableAccesses_[thread][state];
+	}
+
+	/**
+	 * \return True if a transition going from the state may acquire or release the memory lock.
+	 */
+	bool mayLock(std::size_t thread, std::size_t state) const {
+		return localAccesses_[thread][state].writesLock(lock_);
+	}
+
+	/**
+	 * \return True if the transition may acquire or release the memory lock.
+	 */
+	bool mayLock(std::size_t thread, std::size_t state, std::size_t transition) const {
+		return transitionAccesses_[thread][state][transition].writesLock(lock_);
+	}
+
+	/**
+	 * \return True if the transition is a back edge of a depth-first search of the thread
+	 *         from its initial state. Every cycle of the thread contains a back edge.
+	 */
+	bool isBackEdge(std::size_t thread, std::size_t state, std::size_t transition) const {
+		return backEdges_[thread][state][transition];
+	}
+
+	/**
+	 * \return True if the transition may write the interesting memory cell of the program.
+	 */
+	bool isVisible(std::size_t thread, std::size_t state, std::size_t transition) const {
+		return visible_[thread][state][transition];
+	}
+
+	/**
+	 * \return Minimal number of transitions the thread must execute from the state, the last
+	 *         of them being visible, or INFINITE_DISTANCE if no visible transition is reachable.
+	 */
+	std::size_t getVisibleDistance(std::size_t thread, std::size_t state) const {
+		return visibleDistances_[thread][state];
+	}
+};
+
+Accesses computeAccesses(const Program &program, const Census &census);
+
+} // namespace trench
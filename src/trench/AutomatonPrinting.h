@@ -38,8 +38,8 @@ public:
 		return false;
 	}
 
-	bool onTransition(const typename Automaton::Transition &transition) {
-		out_ << 's' << getId(automaton_.getSourceState(transition))
+	bool onTransition(const typename Automaton::State &source, const typename Automaton::Transition &transition) {
+		out_ << 's' << getId(source)
 		     << " -> "
 		     << 's' << getId(automaton_.getDestinationState(transition))
 		     << " [label=\"" << automaton_.getLabel(transition) << "\"];" << std::endl;
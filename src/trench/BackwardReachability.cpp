@@ -0,0 +1,506 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#include "BackwardReachability.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+#include "Census.h"
+#include "Program.h"
+#include "State.h"
+#include "Transition.h"
+
+namespace trench {
+
+namespace {
+
+/**
+ * Constraint on the value of a memory cell: equal or not equal to a constant.
+ */
+struct Constraint {
+	std::size_t cell;
+	bool equal;
+	Domain value;
+
+	bool isSatisfiedBy(Domain actual) const { return (actual == value) == equal; }
+};
+
+inline bool operator<(const Constraint &a, const Constraint &b) {
+	return std::make_tuple(a.cell, a.equal, a.value) < std::make_tuple(b.cell, b.equal, b.value);
+}
+
+inline bool operator==(const Constraint &a, const Constraint &b) {
+	return a.cell == b.cell && a.equal == b.equal && a.value == b.value;
+}
+
+/** Satisfiable set of constraints, sorted, without redundant ones. */
+typedef std::vector<Constraint> Constraints;
+
+/**
+ * Adds a constraint to a set.
+ *
+ * \return False if the constraints have become unsatisfiable, true otherwise.
+ */
+bool addConstraint(Constraints &constraints, const Constraint &constraint) {
+	auto begin = std::lower_bound(constraints.begin(), constraints.end(), Constraint{constraint.cell, false, std::numeric_limits<Domain>::min()});
+	auto end = begin;
+	while (end != constraints.end() && end->cell == constraint.cell) {
+		++end;
+	}
+
+	for (auto i = begin; i != end; ++i) {
+		if (*i == constraint) {
+			return true;
+		}
+		if (i->equal) {
+			/* The value is known: the new constraint either follows or contradicts. */
+			return constraint.isSatisfiedBy(i->value);
+		}
+	}
+
+	if (constraint.equal) {
+		for (auto i = begin; i != end; ++i) {
+			if (!i->isSatisfiedBy(constraint.value)) {
+				return false;
+			}
+		}
+		/* The disequalities follow from the equality. */
+		constraints.erase(begin, end);
+		constraints.insert(std::lower_bound(constraints.begin(), constraints.end(), constraint), constraint);
+	} else {
+		constraints.insert(std::lower_bound(begin, end, constraint), constraint);
+	}
+	return true;
+}
+
+/** Control state of a thread in a partial state which is not fixed. */
+const uint32_t ANY = static_cast<uint32_t>(-1);
+
+/**
+ * Set of the states where the threads with fixed control states are in them
+ * and the cells with fixed values have them.
+ */
+struct PartialState {
+	/** Control state ids, indexed by thread id, ANY if not fixed. */
+	std::vector<uint32_t> controlStates;
+	Constraints cells;
+
+	/**
+	 * \return True if every state of that partial state is a state of this one.
+	 */
+	bool subsumes(const PartialState &that) const {
+		for (std::size_t thread = 0; thread < controlStates.size(); ++thread) {
+			if (controlStates[thread] != ANY && controlStates[thread] != that.controlStates[thread]) {
+				return false;
+			}
+		}
+		return std::includes(that.cells.begin(), that.cells.end(), cells.begin(), cells.end());
+	}
+
+	/**
+	 * \return True if the initial state, with all threads in their initial control states
+	 *         and all the memory zero, is a state of this partial state.
+	 */
+	bool coversInitialState() const {
+		return
+			std::all_of(controlStates.begin(), controlStates.end(),
+				[](uint32_t state) { return state == ANY || state == 0; }) &&
+			std::all_of(cells.begin(), cells.end(),
+				[](const Constraint &constraint) { return constraint.isSatisfiedBy(0); });
+	}
+};
+
+/**
+ * What a transition does to the memory cells with constant addresses.
+ */
+struct Summary {
+	/** False if the transition can never be executed. */
+	bool executable;
+
+	/** Constraints the cells must satisfy for the transition to be executable. */
+	Constraints guards;
+
+	/** Values the transition certainly writes into the cells, sorted by cell. */
+	std::vector<std::pair<std::size_t, Domain>> writes;
+
+	/** Cells the transition may write with unknown values, and spaces it may write at unknown addresses. */
+	std::vector<std::size_t> clobberedCells;
+	std::vector<Space> clobberedSpaces;
+
+	Summary(): executable(true) {}
+
+	bool clobbers(std::size_t cell, Space space) const {
+		return
+			std::find(clobberedCells.begin(), clobberedCells.end(), cell) != clobberedCells.end() ||
+			std::find(clobberedSpaces.begin(), clobberedSpaces.end(), space) != clobberedSpaces.end();
+	}
+};
+
+/**
+ * Computes summaries by executing an instruction symbolically from an unknown state.
+ */
+class Summarizer {
+	const Census &census_;
+
+	/** Value of a register or a cell during the execution: a constant, the initial value of a cell, or unknown. */
+	struct Value {
+		enum Kind { UNKNOWN, CONSTANT, CELL } kind;
+		Domain constant;
+		std::size_t cell;
+
+		static Value unknown() { return Value{UNKNOWN, 0, Census::NO_ID}; }
+		static Value makeConstant(Domain value) { return Value{CONSTANT, value, Census::NO_ID}; }
+		static Value makeCell(std::size_t cell) { return Value{CELL, 0, cell}; }
+	};
+
+	boost::unordered_map<const Register *, Value> registers_;
+	boost::unordered_map<std::size_t, Value> writtenCells_;
+	std::vector<Space> writtenSpaces_;
+	Summary summary_;
+
+public:
+	explicit
+	Summarizer(const Census &census): census_(census) {}
+
+	Summary summarize(const Instruction &instruction) {
+		registers_.clear();
+		writtenCells_.clear();
+		writtenSpaces_.clear();
+		summary_ = Summary();
+
+		execute(instruction);
+
+		for (const auto &written : writtenCells_) {
+			if (written.second.kind == Value::CONSTANT) {
+				summary_.writes.push_back(std::make_pair(written.first, written.second.constant));
+			} else {
+				summary_.clobberedCells.push_back(written.first);
+			}
+		}
+		std::sort(summary_.writes.begin(), summary_.writes.end());
+		summary_.clobberedSpaces = writtenSpaces_;
+
+		return std::move(summary_);
+	}
+
+private:
+	void execute(const Instruction &instruction) {
+		switch (instruction.mnemonic()) {
+			case Instruction::READ: {
+				auto read = instruction.as<Read>();
+				registers_[read->reg().get()] = load(read->space(), evaluate(*read->address()));
+				break;
+			}
+			case Instruction::WRITE: {
+				auto write = instruction.as<Write>();
+				auto value = evaluate(*write->value());
+				auto address = evaluate(*write->address());
+				if (value.kind != Value::CONSTANT) {
+					value = Value::unknown();
+				}
+				std::size_t cell = Census::NO_ID;
+				if (address.kind == Value::CONSTANT) {
+					cell = census_.getCellId(write->space(), address.constant);
+				}
+				if (cell != Census::NO_ID) {
+					writtenCells_[cell] = value;
+				} else {
+					writtenSpaces_.push_back(write->space());
+				}
+				break;
+			}
+			case Instruction::LOCAL: {
+				auto local = instruction.as<Local>();
+				registers_[local->reg().get()] = evaluate(*local->value());
+				break;
+			}
+			case Instruction::CONDITION: {
+				assume(*instruction.as<Condition>()->expression());
+				break;
+			}
+			case Instruction::ATOMIC: {
+				for (const auto &instr : instruction.as<Atomic>()->instructions()) {
+					execute(*instr);
+				}
+				break;
+			}
+			case Instruction::MFENCE: /* FALLTHROUGH */
+			case Instruction::LOCK: /* FALLTHROUGH */
+			case Instruction::UNLOCK: /* FALLTHROUGH */
+			case Instruction::NOOP:
+				break;
+			default: {
+				assert(!"NEVER REACHED");
+			}
+		}
+	}
+
+	Value load(Space space, const Value &address) const {
+		if (address.kind != Value::CONSTANT) {
+			return Value::unknown();
+		}
+		auto cell = census_.getCellId(space, address.constant);
+		if (cell == Census::NO_ID) {
+			return Value::unknown();
+		}
+		auto i = writtenCells_.find(cell);
+		if (i != writtenCells_.end()) {
+			return i->second;
+		}
+		if (std::find(writtenSpaces_.begin(), writtenSpaces_.end(), space) != writtenSpaces_.end()) {
+			return Value::unknown();
+		}
+		return Value::makeCell(cell);
+	}
+
+	Value evaluate(const Expression &expression) const {
+		switch (expression.kind()) {
+			case Expression::CONSTANT:
+				return Value::makeConstant(expression.as<Constant>()->value());
+			case Expression::REGISTER: {
+				auto i = registers_.find(expression.as<Register>());
+				return i != registers_.end() ? i->second : Value::unknown();
+			}
+			case Expression::UNARY: {
+				auto unary = expression.as<UnaryOperator>();
+				auto operand = evaluate(*unary->operand());
+				if (operand.kind != Value::CONSTANT) {
+					return Value::unknown();
+				}
+				switch (unary->kind()) {
+					case UnaryOperator::NOT:
+						return Value::makeConstant(!operand.constant);
+					default: {
+						assert(!"NEVER REACHED");
+					}
+				}
+				break;
+			}
+			case Expression::BINARY: {
+				auto binary = expression.as<BinaryOperator>();
+				auto left = evaluate(*binary->left());
+				auto right = evaluate(*binary->right());
+				if (left.kind != Value::CONSTANT || right.kind != Value::CONSTANT) {
+					return Value::unknown();
+				}
+				auto a = left.constant;
+				auto b = right.constant;
+				switch (binary->kind()) {
+					case BinaryOperator::EQ:      return Value::makeConstant(a == b);
+					case BinaryOperator::NEQ:     return Value::makeConstant(a != b);
+					case BinaryOperator::LT:      return Value::makeConstant(a < b);
+					case BinaryOperator::LEQ:     return Value::makeConstant(a <= b);
+					case BinaryOperator::GT:      return Value::makeConstant(a > b);
+					case BinaryOperator::GEQ:     return Value::makeConstant(a >= b);
+					case BinaryOperator::AND:     return Value::makeConstant(a && b);
+					case BinaryOperator::OR:      return Value::makeConstant(a || b);
+					case BinaryOperator::ADD:     return Value::makeConstant(a + b);
+					case BinaryOperator::SUB:     return Value::makeConstant(a - b);
+					case BinaryOperator::MUL:     return Value::makeConstant(a * b);
+					case BinaryOperator::BIN_AND: return Value::makeConstant(a & b);
+					default: {
+						assert(!"NEVER REACHED");
+					}
+				}
+				break;
+			}
+			case Expression::CAN_ACCESS_MEMORY:
+				return Value::unknown();
+			default: {
+				assert(!"NEVER REACHED");
+			}
+		}
+		return Value::unknown();
+	}
+
+	/**
+	 * Accounts for the condition being true.
+	 */
+	void assume(const Expression &expression) {
+		auto value = evaluate(expression);
+		if (value.kind == Value::CONSTANT) {
+			if (!value.constant) {
+				summary_.executable = false;
+			}
+			return;
+		}
+
+		if (auto binary = expression.as<BinaryOperator>()) {
+			if (binary->kind() == BinaryOperator::AND) {
+				assume(*binary->left());
+				assume(*binary->right());
+			} else if (binary->kind() == BinaryOperator::EQ || binary->kind() == BinaryOperator::NEQ) {
+				auto left = evaluate(*binary->left());
+				auto right = evaluate(*binary->right());
+				if (left.kind == Value::CONSTANT) {
+					std::swap(left, right);
+				}
+				if (left.kind == Value::CELL && right.kind == Value::CONSTANT) {
+					Constraint guard{left.cell, binary->kind() == BinaryOperator::EQ, right.constant};
+					if (!addConstraint(summary_.guards, guard)) {
+						summary_.executable = false;
+					}
+				}
+			}
+		}
+	}
+};
+
+struct ThreadTransition {
+	uint32_t from;
+	uint32_t to;
+	Summary summary;
+};
+
+/**
+ * Computes the partial state of the states from which the transition of the thread
+ * may lead to a state of the given partial state.
+ *
+ * \return True if there may be such states, false if there are certainly none.
+ */
+bool computePreimage(const PartialState &post, std::size_t thread, const ThreadTransition &transition, const Census &census, PartialState &pre) {
+	if (post.controlStates[thread] != ANY && post.controlStates[thread] != transition.to) {
+		return false;
+	}
+
+	const auto &summary = transition.summary;
+
+	pre.controlStates = post.controlStates;
+	pre.controlStates[thread] = transition.from;
+
+	pre.cells.clear();
+	for (const auto &constraint : post.cells) {
+		auto write = std::lower_bound(summary.writes.begin(), summary.writes.end(), std::make_pair(constraint.cell, std::numeric_limits<Domain>::min()));
+		if (write != summary.writes.end() && write->first == constraint.cell) {
+			if (!constraint.isSatisfiedBy(write->second)) {
+				return false;
+			}
+		} else if (!summary.clobbers(constraint.cell, census.cells()[constraint.cell].first)) {
+			pre.cells.push_back(constraint);
+		}
+	}
+
+	for (const auto &guard : summary.guards) {
+		if (!addConstraint(pre.cells, guard)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+} // anonymous namespace
+
+bool isInterestingStateSCUnreachable(const Program &program, std::size_t maxStatesCount) {
+	Census census;
+	census.visit(program);
+
+	auto nthreads = census.threads().size();
+
+	std::vector<std::vector<ThreadTransition>> transitions(nthreads);
+	Summarizer summarizer(census);
+	for (std::size_t thread = 0; thread < nthreads; ++thread) {
+		const auto &states = census.states(thread);
+		for (std::size_t state = 0; state < states.size(); ++state) {
+			for (const Transition *transition : states[state]->out()) {
+				auto summary = summarizer.summarize(*transition->instruction());
+				if (summary.executable) {
+					transitions[thread].push_back(ThreadTransition{
+						static_cast<uint32_t>(state),
+						static_cast<uint32_t>(census.getId(transition->to())),
+						std::move(summary)
+					});
+				}
+			}
+		}
+	}
+
+	std::vector<PartialState> states;
+	std::deque<std::size_t> queue;
+
+	/* Returns true if the state covers the initial one, so that the search is over. */
+	auto add = [&](PartialState state) {
+		for (const auto &visited : states) {
+			if (visited.subsumes(state)) {
+				return false;
+			}
+		}
+		if (state.coversInitialState()) {
+			return true;
+		}
+		queue.push_back(states.size());
+		states.push_back(std::move(state));
+		return false;
+	};
+
+	/* The interesting cell is zero initially, so some transition must write it. */
+	auto interestingSpace = program.interestingSpace();
+	auto interestingCell = census.getCellId(interestingSpace, program.interestingAddress());
+
+	for (std::size_t thread = 0; thread < nthreads; ++thread) {
+		for (const auto &transition : transitions[thread]) {
+			const auto &summary = transition.summary;
+
+			bool visible = summary.clobbers(interestingCell, interestingSpace);
+			for (const auto &write : summary.writes) {
+				if (write.first == interestingCell && write.second != 0) {
+					visible = true;
+				}
+			}
+
+			if (visible) {
+				PartialState state;
+				state.controlStates.assign(nthreads, ANY);
+				state.controlStates[thread] = transition.from;
+				state.cells = summary.guards;
+				if (add(std::move(state))) {
+					return false;
+				}
+			}
+		}
+	}
+
+	PartialState pre;
+	while (!queue.empty()) {
+		if (maxStatesCount != 0 && states.size() > maxStatesCount) {
+			return false;
+		}
+
+		auto post = states[queue.front()];
+		queue.pop_front();
+
+		for (std::size_t thread = 0; thread < nthreads; ++thread) {
+			for (const auto &transition : transitions[thread]) {
+				if (!computePreimage(post, thread, transition, census, pre)) {
+					continue;
+				}
+				if (post.controlStates[thread] == ANY && pre.cells == post.cells) {
+					/* Subsumed by the post state. */
+					continue;
+				}
+				if (add(pre)) {
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+} // namespace trench
@@ -0,0 +1,40 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <trench/config.h>
+
+#include <cstddef>
+
+namespace trench {
+
+class Program;
+
+/**
+ * Checks whether the interesting state of the program is unreachable under SC
+ * using a search backwards from it.
+ *
+ * The search goes over partial states, fixing the control states of some threads
+ * and the values of some memory cells with constant addresses. It computes the partial
+ * states from which the interesting state may be reachable, over-approximating
+ * the predecessors: registers and the memory lock are not tracked, and a transition
+ * constrains only the cells it reads and compares with constants within the same
+ * instruction. If none of the partial states covers the initial state, the interesting
+ * state is unreachable.
+ *
+ * \param program        Program.
+ * \param maxStatesCount Number of partial states after which the search gives up, zero if unlimited.
+ *
+ * \return True if the interesting state is certainly unreachable, false if it may be
+ *         reachable, or if the search has given up.
+ */
+bool isInterestingStateSCUnreachable(const Program &program, std::size_t maxStatesCount);
+
+} // namespace trench
@@ -0,0 +1,243 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#include "Bdd.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include <boost/unordered_map.hpp>
+
+#include "HashMix.h"
+
+namespace trench {
+
+namespace {
+
+const std::size_t INITIAL_BUCKETS_COUNT = 1 << 12;
+const std::size_t MAX_CACHE_SIZE = 1 << 20;
+const BddManager::Bdd INVALID_BDD = static_cast<BddManager::Bdd>(-1);
+
+} // anonymous namespace
+
+const BddManager::Bdd BddManager::ZERO;
+const BddManager::Bdd BddManager::ONE;
+const BddManager::Variable BddManager::TERMINAL;
+
+BddManager::BddManager(std::size_t maxNodesCount):
+	buckets_(INITIAL_BUCKETS_COUNT, ZERO),
+	cache_(INITIAL_BUCKETS_COUNT / 2, CacheEntry{ITE, INVALID_BDD, INVALID_BDD, INVALID_BDD, INVALID_BDD}),
+	maxNodesCount_(maxNodesCount),
+	exhausted_(false)
+{
+	nodes_.push_back(Node{TERMINAL, ZERO, ZERO});
+	nodes_.push_back(Node{TERMINAL, ONE, ONE});
+}
+
+BddManager::Bdd BddManager::makeNode(Variable variable, Bdd low, Bdd high) {
+	if (low == high) {
+		return low;
+	}
+	assert(variable < top(low) && variable < top(high));
+
+	std::size_t mask = buckets_.size() - 1;
+	for (std::size_t i = mixHash(mixHash(variable, low) ^ high) & mask; ; i = (i + 1) & mask) {
+		Bdd bdd = buckets_[i];
+		if (bdd == ZERO) {
+			if (maxNodesCount_ > 0 && nodes_.size() >= maxNodesCount_) {
+				exhausted_ = true;
+				return ZERO;
+			}
+			bdd = static_cast<Bdd>(nodes_.size());
+			nodes_.push_back(Node{variable, low, high});
+			buckets_[i] = bdd;
+			if (nodes_.size() * 2 > buckets_.size()) {
+				grow();
+			}
+			return bdd;
+		}
+		const Node &node = nodes_[bdd];
+		if (node.variable == variable && node.low == low && node.high == high) {
+			return bdd;
+		}
+	}
+}
+
+void BddManager::grow() {
+	buckets_.assign(buckets_.size() * 2, ZERO);
+	std::size_t mask = buckets_.size() - 1;
+	for (std::size_t bdd = ONE + 1; bdd < nodes_.size(); ++bdd) {
+		const Node &node = nodes_[bdd];
+		std::size_t i = mixHash(mixHash(node.variable, node.low) ^ node.high) & mask;
+		while (buckets_[i] != ZERO) {
+			i = (i + 1) & mask;
+		}
+		buckets_[i] = static_cast<Bdd>(bdd);
+	}
+
+	if (cache_.size() < MAX_CACHE_SIZE) {
+		/* Memoized results stay valid, but are rehashed only by forgetting them. */
+		cache_.assign(cache_.size() * 2, CacheEntry{ITE, INVALID_BDD, INVALID_BDD, INVALID_BDD, INVALID_BDD});
+	}
+}
+
+std::size_t BddManager::getCacheIndex(Operation operation, Bdd f, Bdd g, Bdd h) const {
+	return mixHash(mixHash(operation, f) ^ mixHash(g, h)) & (cache_.size() - 1);
+}
+
+bool BddManager::lookup(Operation operation, Bdd f, Bdd g, Bdd h, Bdd &result) const {
+	const CacheEntry &entry = cache_[getCacheIndex(operation, f, g, h)];
+	if (entry.operation == operation && entry.f == f && entry.g == g && entry.h == h) {
+		result = entry.result;
+		return true;
+	}
+	return false;
+}
+
+void BddManager::store(Operation operation, Bdd f, Bdd g, Bdd h, Bdd result) {
+	cache_[getCacheIndex(operation, f, g, h)] = CacheEntry{operation, f, g, h, result};
+}
+
+BddManager::Bdd BddManager::ite(Bdd f, Bdd g, Bdd h) {
+	if (f == ONE) {
+		return g;
+	}
+	if (f == ZERO) {
+		return h;
+	}
+	if (g == h) {
+		return g;
+	}
+	if (g == ONE && h == ZERO) {
+		return f;
+	}
+
+	Bdd result;
+	if (lookup(ITE, f, g, h, result)) {
+		return result;
+	}
+
+	Variable variable = std::min(top(f), std::min(top(g), top(h)));
+	Bdd low = ite(this->low(f, variable), this->low(g, variable), this->low(h, variable));
+	Bdd high = ite(this->high(f, variable), this->high(g, variable), this->high(h, variable));
+	result = makeNode(variable, low, high);
+
+	store(ITE, f, g, h, result);
+	return result;
+}
+
+BddManager::Bdd BddManager::cube(std::vector<Variable> variables) {
+	std::sort(variables.begin(), variables.end());
+	Bdd result = ONE;
+	for (auto i = variables.rbegin(); i != variables.rend(); ++i) {
+		result = makeNode(*i, ZERO, result);
+	}
+	return result;
+}
+
+BddManager::Bdd BddManager::exists(Bdd f, Bdd cube) {
+	while (cube != ONE && top(cube) < top(f)) {
+		cube = nodes_[cube].high;
+	}
+	if (cube == ONE || f == ZERO || f == ONE) {
+		return f;
+	}
+
+	Bdd result;
+	if (lookup(EXISTS, f, cube, ZERO, result)) {
+		return result;
+	}
+
+	const Node &node = nodes_[f];
+	Variable variable = node.variable;
+	Bdd fLow = node.low;
+	Bdd fHigh = node.high;
+
+	if (top(cube) == variable) {
+		Bdd low = exists(fLow, nodes_[cube].high);
+		result = low == ONE ? ONE : bddOr(low, exists(fHigh, nodes_[cube].high));
+	} else {
+		Bdd low = exists(fLow, cube);
+		result = makeNode(variable, low, exists(fHigh, cube));
+	}
+
+	store(EXISTS, f, cube, ZERO, result);
+	return result;
+}
+
+BddManager::Bdd BddManager::andExists(Bdd f, Bdd g, Bdd cube) {
+	if (f == ZERO || g == ZERO) {
+		return ZERO;
+	}
+	if (f == ONE) {
+		return exists(g, cube);
+	}
+	if (g == ONE || f == g) {
+		return exists(f, cube);
+	}
+	if (cube == ONE) {
+		return bddAnd(f, g);
+	}
+	if (f > g) {
+		std::swap(f, g);
+	}
+
+	Variable variable = std::min(top(f), top(g));
+	while (cube != ONE && top(cube) < variable) {
+		cube = nodes_[cube].high;
+	}
+
+	Bdd result;
+	if (lookup(AND_EXISTS, f, g, cube, result)) {
+		return result;
+	}
+
+	if (cube != ONE && top(cube) == variable) {
+		Bdd rest = nodes_[cube].high;
+		Bdd low = andExists(this->low(f, variable), this->low(g, variable), rest);
+		result = low == ONE ? ONE : bddOr(low, andExists(this->high(f, variable), this->high(g, variable), rest));
+	} else {
+		Bdd low = andExists(this->low(f, variable), this->low(g, variable), cube);
+		result = makeNode(variable, low, andExists(this->high(f, variable), this->high(g, variable), cube));
+	}
+
+	store(AND_EXISTS, f, g, cube, result);
+	return result;
+}
+
+BddManager::Bdd BddManager::rename(Bdd f, const std::vector<Variable> &renaming) {
+	boost::unordered_map<Bdd, Bdd> cache;
+
+	/* Renaming preserves the order, so a node is simply relabeled, children first. */
+	struct Renamer {
+		BddManager &manager;
+		const std::vector<Variable> &renaming;
+		boost::unordered_map<Bdd, Bdd> &cache;
+
+		Bdd operator()(Bdd f) {
+			if (f == ZERO || f == ONE) {
+				return f;
+			}
+			auto i = cache.find(f);
+			if (i != cache.end()) {
+				return i->second;
+			}
+			Node node = manager.nodes_[f];
+			Bdd low = (*this)(node.low);
+			Bdd high = (*this)(node.high);
+			Bdd result = manager.makeNode(renaming[node.variable], low, high);
+			cache[f] = result;
+			return result;
+		}
+	};
+
+	return Renamer{*this, renaming, cache}(f);
+}
+
+} // namespace trench
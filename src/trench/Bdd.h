@@ -0,0 +1,136 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <trench/config.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace trench {
+
+/**
+ * Manager of reduced ordered binary decision diagrams.
+ *
+ * A BDD is identified by the index of its root in the table of nodes, the two
+ * terminals having indices ZERO and ONE. Variables are ordered by their numbers.
+ * Nodes are never freed: a manager is meant to serve a single computation.
+ * Once it has made the allowed number of nodes, it is exhausted: it stops making
+ * new ones and the results of all further operations are meaningless.
+ *
+ * The results of operations are memoized in a direct-mapped cache.
+ */
+class BddManager {
+public:
+	typedef uint32_t Bdd;
+	typedef uint32_t Variable;
+
+	static const Bdd ZERO = 0;
+	static const Bdd ONE = 1;
+
+private:
+	/** Variable of the terminals, greater than that of any node. */
+	static const Variable TERMINAL = static_cast<Variable>(-1);
+
+	struct Node {
+		Variable variable;
+		Bdd low;
+		Bdd high;
+	};
+
+	enum Operation : uint32_t {
+		ITE,
+		EXISTS,
+		AND_EXISTS
+	};
+
+	struct CacheEntry {
+		Operation operation;
+		Bdd f;
+		Bdd g;
+		Bdd h;
+		Bdd result;
+	};
+
+	std::vector<Node> nodes_;
+	/** Open-addressing hash table of the nodes, ZERO marking empty buckets. */
+	std::vector<Bdd> buckets_;
+	std::vector<CacheEntry> cache_;
+	std::size_t maxNodesCount_;
+	bool exhausted_;
+
+public:
+	/**
+	 * \param maxNodesCount Number of nodes after which the manager is exhausted, zero if unlimited.
+	 */
+	explicit
+	BddManager(std::size_t maxNodesCount = 0);
+
+	/**
+	 * \return BDD true iff the given variable is true.
+	 */
+	Bdd variable(Variable variable) { return makeNode(variable, ZERO, ONE); }
+
+	/**
+	 * \return BDD of "if f then g else h".
+	 */
+	Bdd ite(Bdd f, Bdd g, Bdd h);
+
+	Bdd bddNot(Bdd f) { return ite(f, ZERO, ONE); }
+	Bdd bddAnd(Bdd f, Bdd g) { return ite(f, g, ZERO); }
+	Bdd bddOr(Bdd f, Bdd g) { return ite(f, ONE, g); }
+	Bdd bddXor(Bdd f, Bdd g) { return ite(f, bddNot(g), g); }
+
+	/**
+	 * \return Conjunction of the given variables, to be used as a set of variables to quantify.
+	 */
+	Bdd cube(std::vector<Variable> variables);
+
+	/**
+	 * \return BDD of f with the variables of the cube existentially quantified.
+	 */
+	Bdd exists(Bdd f, Bdd cube);
+
+	/**
+	 * \return BDD of f and g with the variables of the cube existentially quantified,
+	 *         computed without building the conjunction.
+	 */
+	Bdd andExists(Bdd f, Bdd g, Bdd cube);
+
+	/**
+	 * Renames the variables of a BDD.
+	 *
+	 * \param f       BDD.
+	 * \param renaming Maps each variable to its new name. It must preserve the order
+	 *                 of the variables f depends on.
+	 */
+	Bdd rename(Bdd f, const std::vector<Variable> &renaming);
+
+	/** Number of nodes made, including the terminals. */
+	std::size_t nodesCount() const { return nodes_.size(); }
+
+	/** Whether the manager has run out of nodes. */
+	bool exhausted() const { return exhausted_; }
+
+private:
+	Bdd makeNode(Variable variable, Bdd low, Bdd high);
+	void grow();
+
+	Variable top(Bdd f) const { return nodes_[f].variable; }
+	Bdd low(Bdd f, Variable variable) const { return top(f) == variable ? nodes_[f].low : f; }
+	Bdd high(Bdd f, Variable variable) const { return top(f) == variable ? nodes_[f].high : f; }
+
+	std::size_t getCacheIndex(Operation operation, Bdd f, Bdd g, Bdd h) const;
+	bool lookup(Operation operation, Bdd f, Bdd g, Bdd h, Bdd &result) const;
+	void store(Operation operation, Bdd f, Bdd g, Bdd h, Bdd result);
+};
+
+} // namespace trench
@@ -14,7 +14,7 @@
 namespace trench {
 
 std::ostream &operator<<(std::ostream &out, const Statistics &statistics) {
-	return out
+	out
 		<< " threadsCount " << statistics.threadsCount()
 		<< " statesCount " << statistics.statesCount()
 		<< " transitionsCount " << statistics.transitionsCount()
@@ -23,7 +23,56 @@ std::ostream &operator<<(std::ostream &out, const Statistics &statistics) {
 		<< " infeasibleAttacksCount2 " << statistics.infeasibleAttacksCount2()
 		<< " feasibleAttacksCount " << statistics.feasibleAttacksCount()
 		<< " fencesCount " << statistics.fencesCount()
-		<< " visitedStatesCount " << statistics.visitedStatesCount()
+		<< " visitedStatesCount " << statistics.visitedStatesCount();
+
+	if (statistics.addressInfeasibleAttacksCount() > 0) {
+		out << " addressInfeasibleAttacksCount " << statistics.addressInfeasibleAttacksCount();
+	}
+
+	if (statistics.backwardInfeasibleAttacksCount() > 0) {
+		out << " backwardInfeasibleAttacksCount " << statistics.backwardInfeasibleAttacksCount();
+	}
+
+	if (statistics.statelessSearchesCount() > 0) {
+		out << " statelessSearchesCount " << statistics.statelessSearchesCount();
+	}
+
+	if (statistics.symbolicSearchesCount() > 0) {
+		out << " symbolicSearchesCount " << statistics.symbolicSearchesCount();
+	}
+
+	if (statistics.boundedFeasibleAttacksCount() > 0) {
+		out << " boundedFeasibleAttacksCount " << statistics.boundedFeasibleAttacksCount();
+	}
+
+	if (statistics.originalStatesCount() > 0) {
+		out << " originalStatesCount " << statistics.originalStatesCount();
+	}
+
+	if (statistics.maxWitnessLength() > 0) {
+		out << " maxWitnessLength " << statistics.maxWitnessLength();
+	}
+
+	if (statistics.spilledStatesCount() > 0) {
+		out << " spilledStatesCount " << statistics.spilledStatesCount();
+	}
+
+	if (statistics.sleepSetPrunedTransitionsCount() > 0) {
+		out << " sleepSetPrunedTransitionsCount " << statistics.sleepSetPrunedTransitionsCount();
+	}
+
+	if (statistics.bitstateStatesCount() > 0) {
+		out
+			<< " bitstateFeasibleAttacksCount " << statistics.bitstateFeasibleAttacksCount()
+			<< " bitstateCoverage " << statistics.bitstateCoverage()
+			<< " bitstateCollisionProbability " << statistics.bitstateCollisionProbability();
+	}
+
+	if (statistics.hashCompactionSearchesCount() > 0) {
+		out << " hashCompactionCollisionProbability " << statistics.hashCompactionCollisionProbability();
+	}
+
+	return out
 		<< " cpuTime " << statistics.cpuTime()
 		<< " realTime " << statistics.realTime()
 	;
@@ -13,6 +13,7 @@
 
 #include <atomic>
 #include <iosfwd>
+#include <mutex>
 
 namespace trench {
 
@@ -24,10 +25,28 @@ class Statistics {
 	std::atomic<std::size_t> potentialAttacksCount_;
 	std::atomic<std::size_t> infeasibleAttacksCount1_;
 	std::atomic<std::size_t> infeasibleAttacksCount2_;
+	std::atomic<std::size_t> addressInfeasibleAttacksCount_;
+	std::atomic<std::size_t> backwardInfeasibleAttacksCount_;
 	std::atomic<std::size_t> feasibleAttacksCount_;
 	std::atomic<std::size_t> fencesCount_;
 
 	std::atomic<std::size_t> visitedStatesCount_;
+	std::atomic<std::size_t> sleepSetPrunedTransitionsCount_;
+	std::atomic<std::size_t> statelessSearchesCount_;
+	std::atomic<std::size_t> symbolicSearchesCount_;
+	std::atomic<std::size_t> boundedFeasibleAttacksCount_;
+	std::atomic<std::size_t> originalStatesCount_;
+	std::atomic<std::size_t> maxWitnessLength_;
+	std::atomic<std::size_t> spilledStatesCount_;
+
+	std::atomic<std::size_t> bitstateFeasibleAttacksCount_;
+	std::mutex probabilitiesMutex_;
+	std::size_t bitstateStatesCount_;
+	double bitstateOmittedStatesCount_;
+	double bitstateCollisionProbability_;
+
+	std::atomic<std::size_t> hashCompactionSearchesCount_;
+	double hashCompactionCollisionProbability_;
 
 	long cpuTime_;
 	long realTime_;
@@ -45,10 +64,27 @@ public:
 		potentialAttacksCount_   = 0;
 		infeasibleAttacksCount1_ = 0;
 		infeasibleAttacksCount2_ = 0;
+		addressInfeasibleAttacksCount_ = 0;
+		backwardInfeasibleAttacksCount_ = 0;
 		feasibleAttacksCount_    = 0;
 		fencesCount_             = 0;
 
 		visitedStatesCount_ = 0;
+		sleepSetPrunedTransitionsCount_ = 0;
+		statelessSearchesCount_ = 0;
+		symbolicSearchesCount_ = 0;
+		boundedFeasibleAttacksCount_ = 0;
+		originalStatesCount_ = 0;
+		maxWitnessLength_ = 0;
+		spilledStatesCount_ = 0;
+
+		bitstateFeasibleAttacksCount_ = 0;
+		bitstateStatesCount_          = 0;
+		bitstateOmittedStatesCount_   = 0;
+		bitstateCollisionProbability_ = 0;
+
+		hashCompactionSearchesCount_        = 0;
+		hashCompactionCollisionProbability_ = 0;
 
 		cpuTime_ = 0;
 		realTime_ = 0;
@@ -77,6 +113,14 @@ public:
 	void incInfeasibleAttacksCount2(std::size_t value = 1) { infeasibleAttacksCount2_ += value; }
 	std::size_t infeasibleAttacksCount2() const { return infeasibleAttacksCount2_; }
 
+	/** Infeasible attacks, among those counted by infeasibleAttacksCount1, found so by the analysis of addresses. */
+	void incAddressInfeasibleAttacksCount(std::size_t value = 1) { addressInfeasibleAttacksCount_ += value; }
+	std::size_t addressInfeasibleAttacksCount() const { return addressInfeasibleAttacksCount_; }
+
+	/** Infeasible attacks, among those counted by infeasibleAttacksCount2, found so by the backward search. */
+	void incBackwardInfeasibleAttacksCount(std::size_t value = 1) { backwardInfeasibleAttacksCount_ += value; }
+	std::size_t backwardInfeasibleAttacksCount() const { return backwardInfeasibleAttacksCount_; }
+
 	void incFeasibleAttacksCount(std::size_t value = 1) { feasibleAttacksCount_ += value; }
 	std::size_t feasibleAttacksCount() const { return feasibleAttacksCount_; }
 
@@ -86,6 +130,88 @@ public:
 	void incVisitedStatesCount(std::size_t value) { visitedStatesCount_ += value; }
 	std::size_t visitedStatesCount() const { return visitedStatesCount_; }
 
+	/** Transitions not explored because they were in a sleep set. */
+	void incSleepSetPrunedTransitionsCount(std::size_t value) { sleepSetPrunedTransitionsCount_ += value; }
+	std::size_t sleepSetPrunedTransitionsCount() const { return sleepSetPrunedTransitionsCount_; }
+
+	/** Searches done without keeping the visited states. */
+	void incStatelessSearchesCount(std::size_t value = 1) { statelessSearchesCount_ += value; }
+	std::size_t statelessSearchesCount() const { return statelessSearchesCount_; }
+
+	void incSymbolicSearchesCount(std::size_t value = 1) { symbolicSearchesCount_ += value; }
+	std::size_t symbolicSearchesCount() const { return symbolicSearchesCount_; }
+
+	void incBoundedFeasibleAttacksCount(std::size_t value = 1) { boundedFeasibleAttacksCount_ += value; }
+	std::size_t boundedFeasibleAttacksCount() const { return boundedFeasibleAttacksCount_; }
+
+	/** States of original programs explored once for all the attacks. */
+	void incOriginalStatesCount(std::size_t value) { originalStatesCount_ += value; }
+	std::size_t originalStatesCount() const { return originalStatesCount_; }
+
+	/** Accounts for a path to the interesting state found by a search recording paths, given its number of transitions. */
+	void addWitnessLength(std::size_t value) {
+		auto max = maxWitnessLength_.load();
+		while (max < value && !maxWitnessLength_.compare_exchange_weak(max, value)) {}
+	}
+
+	/** \return Maximal length of the paths to the interesting state found by the searches recording paths. */
+	std::size_t maxWitnessLength() const { return maxWitnessLength_; }
+
+	/** Visited states written out to disk by the search in external memory. */
+	void incSpilledStatesCount(std::size_t value) { spilledStatesCount_ += value; }
+	std::size_t spilledStatesCount() const { return spilledStatesCount_; }
+
+	void incBitstateFeasibleAttacksCount(std::size_t value = 1) { bitstateFeasibleAttacksCount_ += value; }
+	std::size_t bitstateFeasibleAttacksCount() const { return bitstateFeasibleAttacksCount_; }
+
+	/**
+	 * Accounts for a search using bitstate hashing.
+	 *
+	 * \param statesCount          Number of states visited.
+	 * \param omittedStatesCount   Expected number of states missed due to hash collisions.
+	 * \param collisionProbability Probability of a hash collision at the end of the search.
+	 */
+	void addBitstateStatistics(std::size_t statesCount, double omittedStatesCount, double collisionProbability) {
+		std::lock_guard<std::mutex> lock(probabilitiesMutex_);
+		bitstateStatesCount_ += statesCount;
+		bitstateOmittedStatesCount_ += omittedStatesCount;
+		if (bitstateCollisionProbability_ < collisionProbability) {
+			bitstateCollisionProbability_ = collisionProbability;
+		}
+	}
+
+	std::size_t bitstateStatesCount() const { return bitstateStatesCount_; }
+
+	/**
+	 * \return Estimated fraction of states reachable in the searches using bitstate hashing that were actually visited.
+	 */
+	double bitstateCoverage() const {
+		return bitstateStatesCount_ / (bitstateStatesCount_ + bitstateOmittedStatesCount_);
+	}
+
+	/**
+	 * \return Maximal probability of a hash collision over all the searches using bitstate hashing.
+	 */
+	double bitstateCollisionProbability() const { return bitstateCollisionProbability_; }
+
+	/**
+	 * Accounts for a search using hash compaction.
+	 *
+	 * \param collisionProbability Probability of a fingerprint collision in the search.
+	 */
+	void addHashCompactionStatistics(double collisionProbability) {
+		std::lock_guard<std::mutex> lock(probabilitiesMutex_);
+		++hashCompactionSearchesCount_;
+		hashCompactionCollisionProbability_ += collisionProbability;
+	}
+
+	std::size_t hashCompactionSearchesCount() const { return hashCompactionSearchesCount_; }
+
+	/**
+	 * \return Upper bound on the probability of a fingerprint collision in any of the searches using hash compaction.
+	 */
+	double hashCompactionCollisionProbability() const { return hashCompactionCollisionProbability_; }
+
 	void addCpuTime(long milliseconds) { cpuTime_ += milliseconds; }
 	long cpuTime() const { return cpuTime_; }
 
@@ -0,0 +1,131 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <trench/config.h>
+
+#include <cstddef>
+#include <queue>
+#include <tuple>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+#include "Benchmarking.h"
+
+namespace trench {
+
+/**
+ * Best-first search over an automaton, guided by an estimate of the distance to a final state.
+ *
+ * The automaton must provide estimateDistanceToFinal(), returning a lower bound on the number
+ * of transitions from a state to a final state, zero for final states, and std::size_t(-1)
+ * if no final state is reachable. States of the latter kind are not expanded.
+ *
+ * The greedy search expands first the states with the least estimate, the most recently
+ * discovered first among equal ones, so that it dives towards a final state. A* expands first
+ * the states with the least sum of the length of the path found to them and the estimate.
+ * As the estimate is a lower bound which decreases by at most one per transition, the first
+ * final state A* expands is reached by a shortest path.
+ */
+template<class Automaton>
+class BestFirstSearch {
+	typedef typename Automaton::State State;
+
+	static const std::size_t INFINITE_DISTANCE = static_cast<std::size_t>(-1);
+
+	struct Entry {
+		std::size_t priority;
+		std::size_t estimate;
+		std::size_t order;
+		std::size_t depth;
+		State state;
+	};
+
+	/** Ordering of the entries in the queue: the entry to be expanded first is the greatest. */
+	struct Precedes {
+		bool operator()(const Entry &a, const Entry &b) const {
+			return std::make_tuple(a.priority, a.estimate, b.order) > std::make_tuple(b.priority, b.estimate, a.order);
+		}
+	};
+
+	const Automaton &automaton_;
+	bool greedy_;
+
+	/** Visited states and the lengths of the shortest paths found to them. */
+	boost::unordered_map<State, std::size_t> visited_;
+
+	std::priority_queue<Entry, std::vector<Entry>, Precedes> queue_;
+	std::size_t order_;
+
+public:
+	/**
+	 * \param automaton Automaton.
+	 * \param greedy    Whether to do the greedy search instead of A*.
+	 */
+	BestFirstSearch(const Automaton &automaton, bool greedy):
+		automaton_(automaton), greedy_(greedy), order_(0)
+	{}
+
+	~BestFirstSearch() {
+		Statistics::instance().incVisitedStatesCount(visited_.size());
+	}
+
+	/**
+	 * \return True if a final state is reachable from the initial one, false otherwise.
+	 */
+	bool run() {
+		push(automaton_.initialState(), 0);
+
+		typename Automaton::Transition transition;
+
+		while (!queue_.empty()) {
+			Entry entry = queue_.top();
+			queue_.pop();
+
+			if (!greedy_ && visited_.find(entry.state)->second < entry.depth) {
+				/* A shorter path to the state has been found since. */
+				continue;
+			}
+
+			if (automaton_.isFinal(entry.state)) {
+				Statistics::instance().addWitnessLength(entry.depth);
+				return true;
+			}
+
+			auto cursor = automaton_.getTransitionsFrom(entry.state);
+			while (automaton_.getNextTransition(entry.state, cursor, transition)) {
+				push(automaton_.getDestinationState(transition), entry.depth + 1);
+			}
+		}
+
+		return false;
+	}
+
+private:
+	void push(const State &state, std::size_t depth) {
+		auto inserted = visited_.insert(std::make_pair(state, depth));
+		if (!inserted.second) {
+			if (greedy_ || inserted.first->second <= depth) {
+				return;
+			}
+			inserted.first->second = depth;
+		}
+
+		std::size_t estimate = automaton_.estimateDistanceToFinal(state);
+		if (estimate == INFINITE_DISTANCE) {
+			return;
+		}
+
+		queue_.push(Entry{greedy_ ? estimate : depth + estimate, estimate, order_++, depth, state});
+	}
+};
+
+} // namespace trench
@@ -0,0 +1,257 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <trench/config.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_set.hpp>
+
+#include "Benchmarking.h"
+#include "ThreadPool.h"
+
+namespace trench {
+
+/**
+ * Breadth-first search over an automaton, finding a shortest path to a final state.
+ *
+ * The search proceeds level by level. The states of the current level (the frontier)
+ * are split into chunks expanded in parallel. The successors are not looked up in the
+ * set of visited states one at a time: they are collected into batches, one per shard
+ * of the set. Each batch is sorted by hash, freed from duplicates and merged into its
+ * shard by a single worker, so that no locking is needed. Each state of a level keeps
+ * the index of its predecessor in the previous level, which gives the path back.
+ */
+template<class Automaton>
+class Bfs {
+	typedef typename Automaton::State State;
+
+	static const std::size_t NO_PARENT = static_cast<std::size_t>(-1);
+
+	/** Visited state and the index of its predecessor in the previous level. */
+	struct Node {
+		const State *state;
+		std::size_t parent;
+	};
+
+	/** Successor of a state of the frontier, not deduplicated yet. */
+	struct Successor {
+		std::size_t hash;
+		State state;
+		std::size_t parent;
+	};
+
+	const Automaton &automaton_;
+	std::size_t nworkers_;
+
+	/** Visited states, sharded by hash. Elements of node-based sets do not move, so the levels point to them. */
+	std::vector<boost::unordered_set<State>> shards_;
+
+	std::vector<std::vector<Node>> levels_;
+
+	/** Successors of the frontier: batches_[chunk][shard]. */
+	std::vector<std::vector<std::vector<Successor>>> batches_;
+
+	/** New states of the next level found in each shard, and the index of the first final one among them. */
+	std::vector<std::vector<Node>> added_;
+	std::vector<std::size_t> finals_;
+
+	std::vector<State> path_;
+
+public:
+	/**
+	 * \param automaton Automaton.
+	 * \param nworkers  Number of threads expanding and deduplicating the states.
+	 */
+	explicit
+	Bfs(const Automaton &automaton, std::size_t nworkers = 1):
+		automaton_(automaton), nworkers_(std::max<std::size_t>(nworkers, 1))
+	{
+		/* More parts than workers, so that a worker with a small part does not stay idle. */
+		auto nparts = nworkers_ == 1 ? 1 : nworkers_ * 4;
+
+		shards_.resize(nparts);
+		batches_.resize(nparts, std::vector<std::vector<Successor>>(nparts));
+		added_.resize(nparts);
+		finals_.resize(nparts);
+	}
+
+	~Bfs() {
+		std::size_t count = 0;
+		for (const auto &shard : shards_) {
+			count += shard.size();
+		}
+		Statistics::instance().incVisitedStatesCount(count);
+	}
+
+	/**
+	 * \return True if a final state is reachable from the initial one, false otherwise.
+	 */
+	bool run() {
+		auto initialState = automaton_.initialState();
+		auto hash = boost::hash<State>()(initialState);
+		const State *state = &*shards_[hash % shards_.size()].insert(std::move(initialState)).first;
+
+		levels_.push_back(std::vector<Node>(1, Node{state, NO_PARENT}));
+		if (automaton_.isFinal(*state)) {
+			return found(0);
+		}
+
+		std::unique_ptr<ThreadPool<>> pool;
+		if (nworkers_ > 1) {
+			pool = std::make_unique<ThreadPool<>>(nworkers_);
+		}
+
+		while (!levels_.back().empty()) {
+			forEach(pool.get(), batches_.size(), [this](std::size_t chunk) { expand(chunk); });
+			forEach(pool.get(), shards_.size(), [this](std::size_t shard) { merge(shard); });
+
+			std::vector<Node> level;
+			std::size_t finalIndex = NO_PARENT;
+			for (std::size_t shard = 0; shard < shards_.size(); ++shard) {
+				if (finalIndex == NO_PARENT && finals_[shard] != NO_PARENT) {
+					finalIndex = level.size() + finals_[shard];
+				}
+				level.insert(level.end(), added_[shard].begin(), added_[shard].end());
+			}
+			levels_.push_back(std::move(level));
+
+			if (finalIndex != NO_PARENT) {
+				return found(finalIndex);
+			}
+		}
+
+		return false;
+	}
+
+	/**
+	 * \return States on a shortest path from the initial state to a final one,
+	 *         if run() has found one, or an empty vector.
+	 */
+	const std::vector<State> &path() const { return path_; }
+
+private:
+	/**
+	 * Runs job(0), ..., job(count - 1) in the pool, or in the calling thread
+	 * if there is no pool, and waits for all of them to finish.
+	 */
+	template<class Job>
+	static void forEach(ThreadPool<> *pool, std::size_t count, const Job &job) {
+		if (!pool) {
+			for (std::size_t i = 0; i < count; ++i) {
+				job(i);
+			}
+			return;
+		}
+
+		std::mutex mutex;
+		std::condition_variable finished;
+		std::size_t pending = count;
+
+		for (std::size_t i = 0; i < count; ++i) {
+			pool->schedule([&, i] {
+				job(i);
+				std::lock_guard<std::mutex> lock(mutex);
+				if (--pending == 0) {
+					finished.notify_one();
+				}
+			});
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+		finished.wait(lock, [&pending] { return pending == 0; });
+	}
+
+	/**
+	 * Computes the successors of a chunk of the frontier and sorts them into batches by shard.
+	 */
+	void expand(std::size_t chunk) {
+		const auto &frontier = levels_.back();
+		auto &batches = batches_[chunk];
+
+		auto begin = frontier.size() * chunk / batches_.size();
+		auto end = frontier.size() * (chunk + 1) / batches_.size();
+
+		boost::hash<State> hasher;
+		typename Automaton::Transition transition;
+
+		for (auto index = begin; index < end; ++index) {
+			const auto &state = *frontier[index].state;
+			auto cursor = automaton_.getTransitionsFrom(state);
+			while (automaton_.getNextTransition(state, cursor, transition)) {
+				const auto &destination = automaton_.getDestinationState(transition);
+				auto hash = hasher(destination);
+				batches[hash % shards_.size()].push_back(Successor{hash, destination, index});
+			}
+		}
+	}
+
+	/**
+	 * Merges the batches of a shard into the shard, collecting the states not visited before.
+	 */
+	void merge(std::size_t shard) {
+		std::vector<Successor> batch;
+		for (auto &batches : batches_) {
+			std::move(batches[shard].begin(), batches[shard].end(), std::back_inserter(batch));
+			batches[shard].clear();
+		}
+
+		/* Equal states become neighbours. The order of equal hashes is kept for the result to be deterministic. */
+		std::stable_sort(batch.begin(), batch.end(),
+			[](const Successor &a, const Successor &b) { return a.hash < b.hash; });
+
+		auto &visited = shards_[shard];
+		auto &added = added_[shard];
+		added.clear();
+		finals_[shard] = NO_PARENT;
+
+		for (std::size_t i = 0; i < batch.size(); ++i) {
+			if (i > 0 && batch[i].hash == batch[i - 1].hash && batch[i].state == batch[i - 1].state) {
+				continue;
+			}
+			auto inserted = visited.insert(batch[i].state);
+			if (inserted.second) {
+				const State *state = &*inserted.first;
+				if (finals_[shard] == NO_PARENT && automaton_.isFinal(*state)) {
+					finals_[shard] = added.size();
+				}
+				added.push_back(Node{state, batch[i].parent});
+			}
+		}
+	}
+
+	/**
+	 * Reconstructs the path to the given state of the last level.
+	 *
+	 * \return True.
+	 */
+	bool found(std::size_t index) {
+		for (auto level = levels_.size(); level-- > 0; ) {
+			const auto &node = levels_[level][index];
+			path_.push_back(*node.state);
+			index = node.parent;
+		}
+		std::reverse(path_.begin(), path_.end());
+
+		Statistics::instance().addWitnessLength(path_.size() - 1);
+		return true;
+	}
+};
+
+} // namespace trench
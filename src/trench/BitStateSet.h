@@ -0,0 +1,119 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <trench/config.h>
+
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+#include "Benchmarking.h"
+#include "HashMix.h"
+
+namespace trench {
+
+/**
+ * Approximate set of states in the spirit of Holzmann's supertrace (bitstate hashing).
+ *
+ * A state is represented by k bits of a bit array, chosen by k hash functions.
+ * A state is considered to be in the set if all its bits are set. Thus, a state
+ * never inserted can be mistaken for a visited one, and a search using this set
+ * can miss some states. However, any state it reaches is really reachable.
+ *
+ * The set mimics the insert() and size() methods of unordered sets,
+ * so that it can be used as the set of visited states of Dfs.
+ * On destruction, it reports the estimated number of omitted states
+ * and the probability of a hash collision to Statistics.
+ */
+template<class T, class Hash = boost::hash<T>>
+class BitStateSet {
+	std::vector<uint64_t> words_;
+	uint64_t mask_;
+	unsigned nhashes_;
+
+	std::size_t size_;
+	std::size_t bitsCount_;
+
+	/** Expected number of new states mistaken for visited ones. */
+	double omittedStatesCount_;
+
+public:
+	/**
+	 * \param memory  Size of the bit array in bytes. Rounded down to a power of two.
+	 * \param nhashes Number of bits per state.
+	 */
+	explicit
+	BitStateSet(std::size_t memory, unsigned nhashes = 3):
+		nhashes_(nhashes), size_(0), bitsCount_(0), omittedStatesCount_(0)
+	{
+		uint64_t nbits = 64;
+		while (nbits * 2 <= static_cast<uint64_t>(memory) * 8) {
+			nbits *= 2;
+		}
+		words_.resize(nbits / 64);
+		mask_ = nbits - 1;
+	}
+
+	BitStateSet(BitStateSet &&) = default;
+
+	~BitStateSet() {
+		if (!words_.empty()) {
+			Statistics::instance().addBitstateStatistics(size_, omittedStatesCount_, collisionProbability());
+		}
+	}
+
+	/**
+	 * Inserts an element into the set.
+	 *
+	 * \return A pair whose second element is true if the element was considered new.
+	 */
+	std::pair<std::size_t, bool> insert(const T &element) {
+		uint64_t h1 = mixHash(Hash()(element));
+		uint64_t h2 = mixHash(h1) | 1;
+
+		std::size_t newBits = 0;
+		for (unsigned i = 0; i < nhashes_; ++i) {
+			uint64_t bit = (h1 + i * h2) & mask_;
+			uint64_t &word = words_[bit / 64];
+			uint64_t flag = uint64_t(1) << (bit % 64);
+			if (!(word & flag)) {
+				word |= flag;
+				++newBits;
+			}
+		}
+
+		if (newBits == 0) {
+			return std::make_pair(newBits, false);
+		}
+
+		omittedStatesCount_ += collisionProbability();
+		bitsCount_ += newBits;
+		++size_;
+		return std::make_pair(newBits, true);
+	}
+
+	/**
+	 * \return Number of elements considered new on insertion.
+	 */
+	std::size_t size() const { return size_; }
+
+	/**
+	 * \return Probability that a new element is mistaken for an element of the set.
+	 */
+	double collisionProbability() const {
+		return std::pow(static_cast<double>(bitsCount_) / (mask_ + 1), nhashes_);
+	}
+};
+
+} // namespace trench
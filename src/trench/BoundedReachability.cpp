@@ -0,0 +1,260 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#include "BoundedReachability.h"
+
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
+
+#include "Benchmarking.h"
+#include "Sat.h"
+#include "SymbolicEncoding.h"
+#include "Thread.h"
+
+namespace trench {
+
+namespace {
+
+typedef SatSolver::Literal Literal;
+
+/** Number of conflicts after which the SAT solver gives up, over all bounds. */
+const std::size_t MAX_CONFLICTS = 1000;
+
+/**
+ * Boolean algebra of literals of a SAT solver, for SymbolicExecutor.
+ *
+ * Each operation introduces a variable defined by the clauses of its Tseitin
+ * encoding. Operations on constants are folded, and equal gates are shared.
+ */
+class TseitinAlgebra {
+	enum Gate { AND, XOR, ITE };
+
+	SatSolver &solver_;
+	Literal true_;
+	boost::unordered_map<std::tuple<Gate, Literal, Literal, Literal>, Literal> gates_;
+
+public:
+	typedef Literal Bit;
+
+	explicit
+	TseitinAlgebra(SatSolver &solver): solver_(solver), true_(SatSolver::makeLiteral(solver.newVariable())) {
+		solver_.addClause({true_});
+	}
+
+	Bit zero() const { return SatSolver::negate(true_); }
+	Bit one() const { return true_; }
+
+	/**
+	 * \return Literal of a new variable.
+	 */
+	Bit newBit() { return SatSolver::makeLiteral(solver_.newVariable()); }
+
+	Bit bitNot(Bit a) { return SatSolver::negate(a); }
+
+	Bit bitAnd(Bit a, Bit b) {
+		if (a == zero() || b == zero() || a == bitNot(b)) {
+			return zero();
+		}
+		if (a == one() || a == b) {
+			return b;
+		}
+		if (b == one()) {
+			return a;
+		}
+		if (a > b) {
+			std::swap(a, b);
+		}
+
+		Bit gate;
+		if (!makeGate(AND, a, b, 0, gate)) {
+			solver_.addClause({bitNot(gate), a});
+			solver_.addClause({bitNot(gate), b});
+			solver_.addClause({gate, bitNot(a), bitNot(b)});
+		}
+		return gate;
+	}
+
+	Bit bitOr(Bit a, Bit b) { return bitNot(bitAnd(bitNot(a), bitNot(b))); }
+
+	Bit bitXor(Bit a, Bit b) {
+		/* Negations are moved out of the gate, so that it is shared more. */
+		bool negated = SatSolver::isNegated(a) != SatSolver::isNegated(b);
+		if (SatSolver::isNegated(a)) {
+			a = bitNot(a);
+		}
+		if (SatSolver::isNegated(b)) {
+			b = bitNot(b);
+		}
+		if (a == b) {
+			return negated ? one() : zero();
+		}
+		if (a == one()) {
+			return negated ? b : bitNot(b);
+		}
+		if (b == one()) {
+			return negated ? a : bitNot(a);
+		}
+		if (a > b) {
+			std::swap(a, b);
+		}
+
+		Bit gate;
+		if (!makeGate(XOR, a, b, 0, gate)) {
+			solver_.addClause({bitNot(gate), a, b});
+			solver_.addClause({bitNot(gate), bitNot(a), bitNot(b)});
+			solver_.addClause({gate, bitNot(a), b});
+			solver_.addClause({gate, a, bitNot(b)});
+		}
+		return negated ? bitNot(gate) : gate;
+	}
+
+	Bit bitIte(Bit c, Bit a, Bit b) {
+		if (c == one() || a == b) {
+			return a;
+		}
+		if (c == zero()) {
+			return b;
+		}
+		if (a == one() || a == c) {
+			return bitOr(c, b);
+		}
+		if (a == zero() || a == bitNot(c)) {
+			return bitAnd(bitNot(c), b);
+		}
+		if (b == one() || b == bitNot(c)) {
+			return bitOr(bitNot(c), a);
+		}
+		if (b == zero() || b == c) {
+			return bitAnd(c, a);
+		}
+		if (a == bitNot(b)) {
+			return bitNot(bitXor(c, a));
+		}
+		if (SatSolver::isNegated(c)) {
+			c = bitNot(c);
+			std::swap(a, b);
+		}
+
+		Bit gate;
+		if (!makeGate(ITE, c, a, b, gate)) {
+			solver_.addClause({bitNot(c), bitNot(a), gate});
+			solver_.addClause({bitNot(c), a, bitNot(gate)});
+			solver_.addClause({c, bitNot(b), gate});
+			solver_.addClause({c, b, bitNot(gate)});
+			solver_.addClause({bitNot(a), bitNot(b), gate});
+			solver_.addClause({a, b, bitNot(gate)});
+		}
+		return gate;
+	}
+
+private:
+	/**
+	 * Finds the output of a gate, or makes a new one.
+	 *
+	 * \return True if the gate has been found, false if it is new and must be defined.
+	 */
+	bool makeGate(Gate kind, Literal a, Literal b, Literal c, Literal &gate) {
+		auto inserted = gates_.insert(std::make_pair(std::make_tuple(kind, a, b, c), Literal()));
+		if (inserted.second) {
+			inserted.first->second = newBit();
+		}
+		gate = inserted.first->second;
+		return !inserted.second;
+	}
+};
+
+} // anonymous namespace
+
+bool isInterestingStateSCReachableBounded(const Program &program, unsigned width, std::size_t maxDepth) {
+	typedef TseitinAlgebra::Bit Bit;
+
+	SymbolicLayout layout(program, width);
+	SatSolver solver;
+	TseitinAlgebra algebra(solver);
+	SymbolicExecutor<TseitinAlgebra> executor(layout, algebra);
+
+	std::vector<std::pair<std::size_t, const Transition *>> transitions;
+	for (std::size_t thread = 0; thread < layout.census().threads().size(); ++thread) {
+		for (const Transition *transition : layout.census().threads()[thread]->transitions()) {
+			transitions.push_back(std::make_pair(thread, transition));
+		}
+	}
+
+	/* The transition executed at a step is chosen by a number; the numbers of no transition mean doing nothing. */
+	auto choiceWidth = SymbolicLayout::getWidth(transitions.size() + 1);
+
+	auto state = executor.initialState();
+	std::vector<Bit> successor;
+	std::vector<std::vector<std::pair<Bit, Bit>>> updates(layout.size());
+
+	for (std::size_t depth = 0; ; ++depth) {
+		Bit isFinal = executor.isFinal(state);
+		if (!executor.isExact()) {
+			return false;
+		}
+
+		if (isFinal != algebra.zero()) {
+			if (solver.conflictsCount() >= MAX_CONFLICTS) {
+				return false;
+			}
+			switch (solver.solve({isFinal}, MAX_CONFLICTS - solver.conflictsCount())) {
+				case SatSolver::SATISFIABLE:
+					Statistics::instance().addWitnessLength(depth);
+					return true;
+				case SatSolver::UNSATISFIABLE:
+					break;
+				case SatSolver::UNKNOWN:
+					return false;
+			}
+		}
+
+		if (depth == maxDepth) {
+			return false;
+		}
+
+		std::vector<Bit> choice(choiceWidth);
+		for (auto &bit : choice) {
+			bit = algebra.newBit();
+		}
+
+		for (auto &update : updates) {
+			update.clear();
+		}
+
+		for (std::size_t i = 0; i < transitions.size(); ++i) {
+			Bit chosen = algebra.one();
+			for (unsigned j = 0; j < choiceWidth; ++j) {
+				chosen = algebra.bitAnd(chosen, (i >> j) & 1 ? choice[j] : algebra.bitNot(choice[j]));
+			}
+
+			Bit escape;
+			Bit guard = executor.execute(transitions[i].first, *transitions[i].second, state, successor, escape);
+			solver.addClause({algebra.bitNot(chosen), algebra.bitAnd(guard, algebra.bitNot(escape))});
+
+			for (std::size_t bit = 0; bit < layout.size(); ++bit) {
+				if (successor[bit] != state[bit]) {
+					updates[bit].push_back(std::make_pair(chosen, successor[bit]));
+				}
+			}
+		}
+
+		/* At most one transition is chosen, so the updates of a bit are exclusive. */
+		for (std::size_t bit = 0; bit < layout.size(); ++bit) {
+			for (const auto &update : updates[bit]) {
+				state[bit] = algebra.bitIte(update.first, update.second, state[bit]);
+			}
+		}
+	}
+}
+
+} // namespace trench
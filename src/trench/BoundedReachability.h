@@ -0,0 +1,40 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <trench/config.h>
+
+#include <cstddef>
+
+namespace trench {
+
+class Program;
+
+/**
+ * Checks whether the interesting state of the program is reachable under SC
+ * in a bounded number of steps, by bounded model checking.
+ *
+ * Executions of k steps are encoded as a propositional formula over the bits
+ * of SymbolicLayout, which is solved by the built-in SAT solver, for k = 0, 1, ...
+ * up to the given bound. At each step, at most one transition is executed.
+ * An execution found is really one of the program: executions escaping
+ * the encoding are excluded.
+ *
+ * \param program  Program.
+ * \param width    Number of bits in the values of memory cells and registers.
+ * \param maxDepth Maximal number of steps.
+ *
+ * \return True if the interesting state is reachable in at most maxDepth steps,
+ *         false if it is not, or if the program cannot be encoded exactly
+ *         with the given width, or if the SAT solver has given up.
+ */
+bool isInterestingStateSCReachableBounded(const Program &program, unsigned width, std::size_t maxDepth);
+
+} // namespace trench
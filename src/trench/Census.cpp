@@ -14,6 +14,7 @@
 
 #include "Program.h"
 #include "SortAndUnique.h"
+#include "State.h"
 #include "Thread.h"
 #include "Transition.h"
 
@@ -26,9 +27,36 @@ void Census::visit(const Program &program) {
 }
 
 void Census::visit(const Thread *thread) {
+	auto threadId = getId(thread);
+	if (threadId == NO_ID) {
+		threadId = threads_.size();
+		thread2id_[thread] = threadId;
+		threads_.push_back(thread);
+		states_.resize(threads_.size());
+		threadRegisters_.resize(threads_.size());
+
+		auto &states = states_[threadId];
+		if (thread->initialState()) {
+			states.push_back(thread->initialState());
+		}
+		for (const State *state : thread->states()) {
+			if (state != thread->initialState()) {
+				states.push_back(state);
+			}
+		}
+		for (std::size_t i = 0; i < states.size(); ++i) {
+			state2id_[states[i]] = i;
+		}
+	}
+
+	auto oldThread = currentThread_;
+	currentThread_ = threadId;
+
 	for (Transition *transition : thread->transitions()) {
 		visit(transition->instruction());
 	}
+
+	currentThread_ = oldThread;
 }
 
 void Census::visit(const std::shared_ptr<Instruction> &instruction) {
@@ -40,14 +68,14 @@ void Census::visit(const std::shared_ptr<Instruction> &instruction) {
 			Read *read = instruction->as<Read>();
 			visit(read->reg());
 			visit(read->address());
-			spaces_.push_back(read->space());
+			addAccess(read->space(), read->address());
 			break;
 		}
 		case Instruction::WRITE: {
 			Write *write = instruction->as<Write>();
 			visit(write->value());
 			visit(write->address());
-			spaces_.push_back(write->space());
+			addAccess(write->space(), write->address());
 			break;
 		}
 		case Instruction::MFENCE: {
@@ -85,7 +113,21 @@ void Census::visit(const std::shared_ptr<Expression> &expression) {
 	expressions_.push_back(expression.get());
 	unique_ = false;
 
-	if (UnaryOperator *unary = expression->as<UnaryOperator>()) {
+	if (Register *reg = expression->as<Register>()) {
+		auto registerId = getId(reg);
+		if (registerId == NO_ID) {
+			registerId = registers_.size();
+			register2id_[reg] = registerId;
+			registers_.push_back(reg);
+		}
+		if (currentThread_ != NO_ID) {
+			auto &threadRegisters = threadRegisters_[currentThread_];
+			auto i = std::lower_bound(threadRegisters.begin(), threadRegisters.end(), registerId);
+			if (i == threadRegisters.end() || *i != registerId) {
+				threadRegisters.insert(i, registerId);
+			}
+		}
+	} else if (UnaryOperator *unary = expression->as<UnaryOperator>()) {
 		visit(unary->operand());
 	} else if (BinaryOperator *binary = expression->as<BinaryOperator>()) {
 		visit(binary->left());
@@ -93,6 +135,20 @@ void Census::visit(const std::shared_ptr<Expression> &expression) {
 	}
 }
 
+void Census::addAccess(Space space, const std::shared_ptr<Expression> &address) {
+	spaces_.push_back(space);
+	if (Constant *constant = address->as<Constant>()) {
+		addCell(space, constant->value());
+	}
+}
+
+void Census::addCell(Space space, Address address) {
+	if (getCellId(space, address) == NO_ID) {
+		cell2id_[std::make_pair(space, address)] = cells_.size();
+		cells_.push_back(std::make_pair(space, address));
+	}
+}
+
 void Census::unique() const {
 	if (unique_) {
 		return;
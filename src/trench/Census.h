@@ -11,23 +11,56 @@
 
 #include <trench/config.h>
 
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
 #include "Expression.h"
 #include "Instruction.h"
 
 namespace trench {
 
 class Program;
+class State;
 class Thread;
 
+/**
+ * Collects the entities a program consists of.
+ *
+ * Besides collecting instructions, expressions and spaces, the census works
+ * as a symbol table: it gives dense integer ids to threads, control states,
+ * registers and memory cells with constant addresses. The ids are assigned
+ * in the order of the first visit, so they do not depend on heap addresses.
+ *
+ * Control states are numbered within their thread, the initial state getting
+ * id zero. Registers and cells are numbered program-wide.
+ */
 class Census {
 	mutable std::vector<Instruction *> instructions_;
 	mutable std::vector<Expression *> expressions_;
 	mutable std::vector<Space> spaces_;
 	mutable bool unique_;
 
+	std::vector<const Thread *> threads_;
+	boost::unordered_map<const Thread *, std::size_t> thread2id_;
+
+	std::vector<std::vector<const State *>> states_;
+	boost::unordered_map<const State *, std::size_t> state2id_;
+
+	std::vector<const Register *> registers_;
+	boost::unordered_map<const Register *, std::size_t> register2id_;
+	std::vector<std::vector<std::size_t>> threadRegisters_;
+
+	std::vector<std::pair<Space, Address>> cells_;
+	boost::unordered_map<std::pair<Space, Address>, std::size_t> cell2id_;
+
+	std::size_t currentThread_;
+
 	public:
 
-	Census(): unique_(false) {}
+	static const std::size_t NO_ID = static_cast<std::size_t>(-1);
+
+	Census(): unique_(false), currentThread_(NO_ID) {}
 
 	void visit(const Program &program);
 	void visit(const Thread *thread);
@@ -37,10 +70,40 @@ class Census {
 	const std::vector<Instruction *> &instructions() const { unique(); return instructions_; }
 	const std::vector<Expression *> &expressions() const { unique(); return expressions_; }
 	const std::vector<Space> &spaces() const { unique(); return spaces_; }
-	
+
+	const std::vector<const Thread *> &threads() const { return threads_; }
+	std::size_t getId(const Thread *thread) const { return find(thread2id_, thread); }
+
+	const std::vector<const State *> &states(std::size_t thread) const { return states_[thread]; }
+	std::size_t getId(const State *state) const { return find(state2id_, state); }
+
+	const std::vector<const Register *> &registers() const { return registers_; }
+	std::size_t getId(const Register *reg) const { return find(register2id_, reg); }
+
+	/**
+	 * \return Ids of the registers used by the given thread, in increasing order.
+	 */
+	const std::vector<std::size_t> &registers(std::size_t thread) const { return threadRegisters_[thread]; }
+
+	const std::vector<std::pair<Space, Address>> &cells() const { return cells_; }
+	std::size_t getCellId(Space space, Address address) const { return find(cell2id_, std::make_pair(space, address)); }
+
+	/**
+	 * Registers a memory cell, even if no instruction accesses it at a constant address.
+	 */
+	void addCell(Space space, Address address);
+
 	private:
 
 	void unique() const;
+
+	template<class Map, class Key>
+	static std::size_t find(const Map &map, const Key &key) {
+		auto i = map.find(key);
+		return i != map.end() ? i->second : NO_ID;
+	}
+
+	void addAccess(Space space, const std::shared_ptr<Expression> &address);
 };
 
 } // namespace trench
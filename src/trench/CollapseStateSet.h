@@ -0,0 +1,148 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <trench/config.h>
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "HashMix.h"
+#include "SCSemantics.h"
+
+namespace trench {
+
+/**
+ * Table giving dense ids to byte strings (hash consing).
+ *
+ * The strings are stored back to back in a single buffer,
+ * the hash table only keeps their ids.
+ */
+class InternTable {
+	std::vector<unsigned char> bytes_;
+
+	/** End offsets of the strings in the buffer, indexed by id. */
+	std::vector<std::size_t> ends_;
+
+	/** Open-addressing hash table of ids plus one, zero marking an empty slot. Its size is a power of two. */
+	std::vector<uint32_t> slots_;
+
+public:
+	InternTable(): slots_(64) {}
+
+	/**
+	 * Finds the id of the given string, adding the string to the table if necessary.
+	 *
+	 * \param[in]  data     String.
+	 * \param[in]  size     Length of the string.
+	 * \param[out] inserted Set to true if the string was not in the table before, false otherwise.
+	 *
+	 * \return Id of the string.
+	 */
+	uint32_t intern(const unsigned char *data, std::size_t size, bool &inserted) {
+		uint64_t mask = slots_.size() - 1;
+		uint64_t i = mixHash(data, size) & mask;
+		for (; slots_[i] != 0; i = (i + 1) & mask) {
+			uint32_t id = slots_[i] - 1;
+			if (equals(id, data, size)) {
+				inserted = false;
+				return id;
+			}
+		}
+
+		uint32_t id = static_cast<uint32_t>(ends_.size());
+		bytes_.insert(bytes_.end(), data, data + size);
+		ends_.push_back(bytes_.size());
+		slots_[i] = id + 1;
+
+		if (2 * ends_.size() > slots_.size()) {
+			grow();
+		}
+
+		inserted = true;
+		return id;
+	}
+
+	std::size_t size() const { return ends_.size(); }
+
+private:
+	std::size_t begin(uint32_t id) const { return id == 0 ? 0 : ends_[id - 1]; }
+
+	bool equals(uint32_t id, const unsigned char *data, std::size_t size) const {
+		return ends_[id] - begin(id) == size && std::memcmp(bytes_.data() + begin(id), data, size) == 0;
+	}
+
+	void grow() {
+		std::vector<uint32_t> slots(slots_.size() * 2);
+		uint64_t mask = slots.size() - 1;
+		for (uint32_t id = 0; id < ends_.size(); ++id) {
+			uint64_t i = mixHash(bytes_.data() + begin(id), ends_[id] - begin(id)) & mask;
+			while (slots[i] != 0) {
+				i = (i + 1) & mask;
+			}
+			slots[i] = id + 1;
+		}
+		slots_.swap(slots);
+	}
+};
+
+/**
+ * Set of SC states using collapse compression.
+ *
+ * Each component of a state (see SCStateLayout::components()), as well as the list
+ * of memory cells with dynamic addresses, is interned in a table of its own.
+ * A state is stored as the tuple of the ids of its components. As neighbouring states
+ * usually differ in a single component, the components are shared by many states.
+ *
+ * The set mimics the insert() and size() methods of unordered sets,
+ * so that it can be used as the set of visited states of Dfs.
+ */
+class CollapseStateSet {
+	const SCStateLayout &layout_;
+
+	/** Tables of components, the last one being for the overflow cells. */
+	std::vector<InternTable> components_;
+
+	InternTable states_;
+
+	std::vector<uint32_t> tuple_;
+
+public:
+	explicit
+	CollapseStateSet(const SCStateLayout &layout):
+		layout_(layout), components_(layout.components().size() + 1)
+	{}
+
+	/**
+	 * Inserts a state into the set.
+	 *
+	 * \return A pair of the id of the state and a flag telling whether it was not in the set before.
+	 */
+	std::pair<uint32_t, bool> insert(const SCState &state) {
+		const auto &components = layout_.components();
+		const unsigned char *data = state.bytes().data();
+		bool inserted;
+
+		tuple_.clear();
+		for (std::size_t i = 0; i < components.size(); ++i) {
+			tuple_.push_back(components_[i].intern(data + components[i].offset, components[i].size, inserted));
+		}
+		tuple_.push_back(components_.back().intern(data + layout_.size(), state.size() - layout_.size(), inserted));
+
+		uint32_t id = states_.intern(reinterpret_cast<const unsigned char *>(tuple_.data()), tuple_.size() * sizeof(uint32_t), inserted);
+		return std::make_pair(id, inserted);
+	}
+
+	std::size_t size() const { return states_.size(); }
+};
+
+} // namespace trench
@@ -0,0 +1,70 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <trench/config.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_set.hpp>
+
+namespace trench {
+
+/**
+ * Set supporting concurrent insertions.
+ *
+ * Elements are distributed over a number of shards by their hash,
+ * each shard being a set protected by its own mutex.
+ */
+template<class T, class Set = boost::unordered_set<T>>
+class ConcurrentSet {
+	struct Shard {
+		std::mutex mutex;
+		Set set;
+	};
+
+	std::vector<std::unique_ptr<Shard>> shards_;
+
+public:
+	explicit
+	ConcurrentSet(std::size_t nshards = 64) {
+		shards_.reserve(nshards);
+		for (std::size_t i = 0; i < nshards; ++i) {
+			shards_.push_back(std::make_unique<Shard>());
+		}
+	}
+
+	/**
+	 * Inserts an element into the set.
+	 *
+	 * \return True if the element was not in the set before, false otherwise.
+	 */
+	bool insert(const T &element) {
+		auto hash = boost::hash<T>()(element);
+		auto &shard = *shards_[(hash ^ (hash >> 17)) % shards_.size()];
+
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		return shard.set.insert(element).second;
+	}
+
+	std::size_t size() {
+		std::size_t result = 0;
+		for (auto &shard : shards_) {
+			std::lock_guard<std::mutex> lock(shard->mutex);
+			result += shard->set.size();
+		}
+		return result;
+	}
+};
+
+} // namespace trench
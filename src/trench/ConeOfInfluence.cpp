@@ -0,0 +1,300 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#include "ConeOfInfluence.h"
+
+#include <cassert>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include <boost/unordered_set.hpp>
+
+#include "Census.h"
+#include "Program.h"
+#include "State.h"
+#include "Transition.h"
+
+namespace trench {
+
+namespace {
+
+class Relevance {
+	boost::unordered_set<std::pair<Space, Domain>> cells_;
+
+	/** Spaces having relevant cells. */
+	boost::unordered_set<Space> spaces_;
+
+	/** Spaces read at addresses unknown statically, all their cells being relevant. */
+	boost::unordered_set<Space> anywhere_;
+
+	boost::unordered_set<const Register *> registers_;
+
+	bool changed_;
+
+public:
+	Relevance(Space space, Domain address): changed_(false) {
+		cells_.insert(std::make_pair(space, address));
+		spaces_.insert(space);
+	}
+
+	/**
+	 * \return True if something has become relevant since the last call.
+	 */
+	bool changed() {
+		bool result = changed_;
+		changed_ = false;
+		return result;
+	}
+
+	bool isRelevant(const Register *reg) const {
+		return registers_.find(reg) != registers_.end();
+	}
+
+	bool isRelevant(const Write &write) const {
+		if (anywhere_.find(write.space()) != anywhere_.end()) {
+			return true;
+		} else if (auto constant = write.address()->as<Constant>()) {
+			return cells_.find(std::make_pair(write.space(), constant->value())) != cells_.end();
+		} else {
+			return spaces_.find(write.space()) != spaces_.end();
+		}
+	}
+
+	/**
+	 * \return True if the instruction may write a relevant cell or acquire or release the memory lock.
+	 */
+	bool isEffective(const Instruction &instruction) const {
+		switch (instruction.mnemonic()) {
+			case Instruction::WRITE:
+				return isRelevant(*instruction.as<Write>());
+			case Instruction::LOCK:
+			case Instruction::UNLOCK:
+				return true;
+			case Instruction::ATOMIC:
+				for (const auto &instr : instruction.as<Atomic>()->instructions()) {
+					if (isEffective(*instr)) {
+						return true;
+					}
+				}
+				return false;
+			default:
+				return false;
+		}
+	}
+
+	/**
+	 * Makes relevant what the instruction uses to compute relevant values or to decide whether it executes.
+	 */
+	void addUses(const Instruction &instruction) {
+		switch (instruction.mnemonic()) {
+			case Instruction::READ: {
+				auto read = instruction.as<Read>();
+				if (isRelevant(read->reg().get())) {
+					addUses(*read->address());
+					if (auto constant = read->address()->as<Constant>()) {
+						if (cells_.insert(std::make_pair(read->space(), constant->value())).second) {
+							spaces_.insert(read->space());
+							changed_ = true;
+						}
+					} else if (anywhere_.insert(read->space()).second) {
+						changed_ = true;
+					}
+				}
+				break;
+			}
+			case Instruction::WRITE: {
+				auto write = instruction.as<Write>();
+				if (isRelevant(*write)) {
+					addUses(*write->value());
+					addUses(*write->address());
+				}
+				break;
+			}
+			case Instruction::LOCAL: {
+				auto local = instruction.as<Local>();
+				if (isRelevant(local->reg().get())) {
+					addUses(*local->value());
+				}
+				break;
+			}
+			case Instruction::CONDITION: {
+				addUses(*instruction.as<Condition>()->expression());
+				break;
+			}
+			case Instruction::ATOMIC: {
+				for (const auto &instr : instruction.as<Atomic>()->instructions()) {
+					addUses(*instr);
+				}
+				break;
+			}
+			case Instruction::MFENCE:
+			case Instruction::NOOP:
+			case Instruction::LOCK:
+			case Instruction::UNLOCK:
+				break;
+			default: {
+				assert(!"NEVER REACHED");
+			}
+		}
+	}
+
+	/**
+	 * \return The instruction without the reads and local assignments of irrelevant registers
+	 *         and without the writes of irrelevant cells, or NULL if nothing remains of it.
+	 */
+	std::shared_ptr<Instruction> prune(const std::shared_ptr<Instruction> &instruction) const {
+		switch (instruction->mnemonic()) {
+			case Instruction::READ:
+				return isRelevant(instruction->as<Read>()->reg().get()) ? instruction : NULL;
+			case Instruction::LOCAL:
+				return isRelevant(instruction->as<Local>()->reg().get()) ? instruction : NULL;
+			case Instruction::WRITE:
+				return isRelevant(*instruction->as<Write>()) ? instruction : NULL;
+			case Instruction::ATOMIC: {
+				const auto &instructions = instruction->as<Atomic>()->instructions();
+				std::vector<std::shared_ptr<Instruction>> pruned;
+				for (const auto &instr : instructions) {
+					if (auto result = prune(instr)) {
+						pruned.push_back(std::move(result));
+					}
+				}
+				if (pruned.empty()) {
+					return NULL;
+				} else if (pruned == instructions) {
+					return instruction;
+				} else {
+					return std::make_shared<Atomic>(std::move(pruned));
+				}
+			}
+			default:
+				return instruction;
+		}
+	}
+
+private:
+	void addUses(const Expression &expression) {
+		if (auto reg = expression.as<Register>()) {
+			if (registers_.insert(reg).second) {
+				changed_ = true;
+			}
+		} else if (auto unary = expression.as<UnaryOperator>()) {
+			addUses(*unary->operand());
+		} else if (auto binary = expression.as<BinaryOperator>()) {
+			addUses(*binary->left());
+			addUses(*binary->right());
+		}
+	}
+};
+
+} // anonymous namespace
+
+Program pruneConeOfInfluence(const Program &program) {
+	Census census;
+	census.visit(program);
+
+	const auto nthreads = census.threads().size();
+
+	/* Whether the transitions from a control state are kept, indexed by thread and state id. */
+	std::vector<std::vector<bool>> live(nthreads);
+
+	Relevance relevance(program.interestingSpace(), program.interestingAddress());
+
+	/* Relevance only grows: iterate until nothing new becomes relevant. */
+	do {
+		for (std::size_t thread = 0; thread < nthreads; ++thread) {
+			const auto &states = census.states(thread);
+			auto &threadLive = live[thread];
+			threadLive.assign(states.size(), false);
+
+			std::deque<std::size_t> queue;
+			for (std::size_t state = 0; state < states.size(); ++state) {
+				for (const Transition *transition : states[state]->out()) {
+					if (!threadLive[state] && relevance.isEffective(*transition->instruction())) {
+						threadLive[state] = true;
+						queue.push_back(state);
+					}
+				}
+			}
+			while (!queue.empty()) {
+				auto state = queue.front();
+				queue.pop_front();
+				for (const Transition *transition : states[state]->in()) {
+					auto from = census.getId(transition->from());
+					if (!threadLive[from]) {
+						threadLive[from] = true;
+						queue.push_back(from);
+					}
+				}
+			}
+
+			for (std::size_t state = 0; state < states.size(); ++state) {
+				if (threadLive[state]) {
+					for (const Transition *transition : states[state]->out()) {
+						relevance.addUses(*transition->instruction());
+					}
+				}
+			}
+		}
+	} while (relevance.changed());
+
+	Program result;
+	result.setInterestingAddress(program.interestingAddress(), program.interestingSpace());
+
+	for (std::size_t thread = 0; thread < nthreads; ++thread) {
+		const Thread *original = census.threads()[thread];
+		Thread *resultThread = result.makeThread(original->name());
+
+		if (!original->initialState()) {
+			continue;
+		}
+
+		/* Control states reachable from the initial one by the transitions kept. */
+		const auto &states = census.states(thread);
+		std::vector<bool> reachable(states.size());
+		reachable[0] = true;
+		std::deque<std::size_t> queue(1, 0);
+		while (!queue.empty()) {
+			auto state = queue.front();
+			queue.pop_front();
+			if (live[thread][state]) {
+				for (const Transition *transition : states[state]->out()) {
+					auto to = census.getId(transition->to());
+					if (!reachable[to]) {
+						reachable[to] = true;
+						queue.push_back(to);
+					}
+				}
+			}
+		}
+
+		resultThread->setInitialState(resultThread->makeState(original->initialState()->name()));
+
+		for (const Transition *transition : original->transitions()) {
+			auto from = census.getId(transition->from());
+			if (!reachable[from] || !live[thread][from]) {
+				continue;
+			}
+
+			auto instruction = relevance.prune(transition->instruction());
+			if (!instruction) {
+				instruction = std::make_shared<Noop>();
+			}
+
+			resultThread->makeTransition(
+				resultThread->makeState(transition->from()->name()),
+				resultThread->makeState(transition->to()->name()),
+				std::move(instruction));
+		}
+	}
+
+	return result;
+}
+
+} // namespace trench
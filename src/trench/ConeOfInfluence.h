@@ -0,0 +1,34 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <trench/config.h>
+
+namespace trench {
+
+class Program;
+
+/**
+ * Removes from the program what cannot influence whether its interesting cell gets written.
+ *
+ * A memory cell is relevant if it is the interesting one or if its value may be read into
+ * a relevant register by a transition that is kept. A register is relevant if a kept
+ * transition uses its value. A transition is kept if from its source state the thread can
+ * still write a relevant cell or acquire or release the memory lock. The other transitions
+ * are removed, and so are the control states no longer reachable, the reads and local
+ * assignments of irrelevant registers, and the writes of irrelevant cells.
+ *
+ * The interesting cell is written in the result if and only if it is written in the program.
+ * Threads, control states and registers kept are named as in the program, and registers are
+ * the same objects.
+ */
+Program pruneConeOfInfluence(const Program &program);
+
+} // namespace trench
@@ -11,14 +11,87 @@
 
 #include <trench/config.h>
 
+#include <cstddef>
+
 namespace trench {
 
 class Configuration {
+public:
+	/** Order in which the exact search visits the states. */
+	enum SearchOrder {
+		DEPTH_FIRST,
+		BREADTH_FIRST,
+		/** States estimated to be closest to the interesting state first (greedy best-first search). */
+		GREEDY,
+		/** States with the least length of the path to them plus the estimated distance first (A*). */
+		A_STAR
+	};
+
+	/** Representation of states used by the search for attacks. */
+	enum Backend {
+		/** States are enumerated one by one. */
+		EXPLICIT,
+		/** Sets of states are represented by binary decision diagrams. */
+		BDD,
+		/** Executions of bounded length are encoded into propositional formulas. */
+		BMC
+	};
+
+private:
 	bool partialOrderReduction_;
 	bool livenessOptimization_;
+	std::size_t workersCount_;
+	std::size_t bitstateMemory_;
+	bool hashCompaction_;
+	bool collapseCompression_;
+	bool inPlaceSearch_;
+	bool amplePartialOrderReduction_;
+	bool sleepSets_;
+	bool symmetryReduction_;
+	bool statelessSearch_;
+	std::size_t statelessSearchLimit_;
+	SearchOrder searchOrder_;
+	std::size_t memoryLimit_;
+	bool backwardSearch_;
+	std::size_t backwardSearchLimit_;
+	Backend backend_;
+	unsigned symbolicWidth_;
+	std::size_t bddNodesLimit_;
+	std::size_t symbolicThreshold_;
+	std::size_t bmcDepth_;
+	bool originalStatesSharing_;
+	std::size_t originalStatesLimit_;
+	bool jointAttackSearch_;
+	bool coneOfInfluence_;
 
 public:
-	Configuration(): partialOrderReduction_(true), livenessOptimization_(true) {}
+	Configuration():
+		partialOrderReduction_(true),
+		livenessOptimization_(true),
+		workersCount_(1),
+		bitstateMemory_(0),
+		hashCompaction_(false),
+		collapseCompression_(false),
+		inPlaceSearch_(true),
+		amplePartialOrderReduction_(false),
+		sleepSets_(false),
+		symmetryReduction_(true),
+		statelessSearch_(true),
+		statelessSearchLimit_(4096),
+		searchOrder_(DEPTH_FIRST),
+		memoryLimit_(0),
+		backwardSearch_(true),
+		backwardSearchLimit_(4096),
+		backend_(EXPLICIT),
+		symbolicWidth_(8),
+		bddNodesLimit_(1 << 20),
+		symbolicThreshold_(1 << 16),
+		bmcDepth_(16),
+		originalStatesSharing_(true),
+		originalStatesLimit_(1 << 20),
+		jointAttackSearch_(false),
+		coneOfInfluence_(true)
+	{}
 
 	static Configuration &instance() {
 		static Configuration configuration;
@@ -30,6 +103,98 @@ public:
 
 	bool livenessOptimization() const { return livenessOptimization_; }
 	void setLivenessOptimization(bool value) { livenessOptimization_ =  value; }
+
+	/** Number of threads exploring the state space of the program checked as a whole. */
+	std::size_t workersCount() const { return workersCount_; }
+	void setWorkersCount(std::size_t value) { workersCount_ = value; }
+
+	/** Size of the bit array for bitstate hashing in bytes, zero if bitstate hashing is off. */
+	std::size_t bitstateMemory() const { return bitstateMemory_; }
+	void setBitstateMemory(std::size_t value) { bitstateMemory_ = value; }
+
+	/** Whether the sets of visited states keep only 64-bit fingerprints of the states. */
+	bool hashCompaction() const { return hashCompaction_; }
+	void setHashCompaction(bool value) { hashCompaction_ = value; }
+
+	/** Whether the sets of visited states share equal components of different states. */
+	bool collapseCompression() const { return collapseCompression_; }
+	void setCollapseCompression(bool value) { collapseCompression_ = value; }
+
+	/** Whether the sequential search changes a single state in place instead of copying states. */
+	bool inPlaceSearch() const { return inPlaceSearch_; }
+	void setInPlaceSearch(bool value) { inPlaceSearch_ = value; }
+
+	/** Whether the search explores only an ample set of the transitions of a single thread when possible. */
+	bool amplePartialOrderReduction() const { return amplePartialOrderReduction_; }
+	void setAmplePartialOrderReduction(bool value) { amplePartialOrderReduction_ = value; }
+
+	/** Whether the sequential exact search prunes transitions with sleep sets. */
+	bool sleepSets() const { return sleepSets_; }
+	void setSleepSets(bool value) { sleepSets_ = value; }
+
+	/** Whether states differing only by a permutation of interchangeable threads are identified. */
+	bool symmetryReduction() const { return symmetryReduction_; }
+	void setSymmetryReduction(bool value) { symmetryReduction_ = value; }
+
+	/** Whether attacks on programs with acyclic threads are checked by the stateless search with dynamic partial order reduction. */
+	bool statelessSearch() const { return statelessSearch_; }
+	void setStatelessSearch(bool value) { statelessSearch_ = value; }
+
+	/** Number of states after which the stateless search gives up in favour of the search keeping the visited states, zero if unlimited. */
+	std::size_t statelessSearchLimit() const { return statelessSearchLimit_; }
+	void setStatelessSearchLimit(std::size_t value) { statelessSearchLimit_ = value; }
+
+	/** Order in which the exact search keeping the visited states in full visits them. */
+	SearchOrder searchOrder() const { return searchOrder_; }
+	void setSearchOrder(SearchOrder value) { searchOrder_ = value; }
+
+	/** Memory in bytes the exact search may use for the visited states before writing them out to disk, zero if unlimited. */
+	std::size_t memoryLimit() const { return memoryLimit_; }
+	void setMemoryLimit(std::size_t value) { memoryLimit_ = value; }
+
+	/** Whether attacks are first checked by the over-approximating search backwards from the interesting state. */
+	bool backwardSearch() const { return backwardSearch_; }
+	void setBackwardSearch(bool value) { backwardSearch_ = value; }
+
+	/** Number of partial states after which the backward search gives up, zero if unlimited. */
+	std::size_t backwardSearchLimit() const { return backwardSearchLimit_; }
+	void setBackwardSearchLimit(std::size_t value) { backwardSearchLimit_ = value; }
+
+	/** Representation of states used by the search for attacks. */
+	Backend backend() const { return backend_; }
+	void setBackend(Backend value) { backend_ = value; }
+
+	/** Number of bits in the values of memory cells and registers encoded symbolically. */
+	unsigned symbolicWidth() const { return symbolicWidth_; }
+	void setSymbolicWidth(unsigned value) { symbolicWidth_ = value; }
+
+	/** Number of BDD nodes after which the symbolic search gives up in favour of the explicit one, zero if unlimited. */
+	std::size_t bddNodesLimit() const { return bddNodesLimit_; }
+	void setBddNodesLimit(std::size_t value) { bddNodesLimit_ = value; }
+
+	/** Number of states the explicit search visits before an attack is searched symbolically, zero to search symbolically at once. */
+	std::size_t symbolicThreshold() const { return symbolicThreshold_; }
+	void setSymbolicThreshold(std::size_t value) { symbolicThreshold_ = value; }
+
+	/** Maximal number of steps of the executions searched by bounded model checking. */
+	std::size_t bmcDepth() const { return bmcDepth_; }
+	void setBmcDepth(std::size_t value) { bmcDepth_ = value; }
+
+	/** Whether the states of the original program are explored once and shared by the searches for all attacks. */
+	bool originalStatesSharing() const { return originalStatesSharing_; }
+	void setOriginalStatesSharing(bool value) { originalStatesSharing_ = value; }
+
+	/** Number of shared states of the original program after which they are not shared, zero if unlimited. */
+	std::size_t originalStatesLimit() const { return originalStatesLimit_; }
+	void setOriginalStatesLimit(std::size_t value) { originalStatesLimit_ = value; }
+
+	/** Whether the feasible attacks for computing fences are all found by a single exploration. */
+	bool jointAttackSearch() const { return jointAttackSearch_; }
+	void setJointAttackSearch(bool value) { jointAttackSearch_ = value; }
+
+	/** Whether the program instrumented for an attack is pruned to what can influence its completion. */
+	bool coneOfInfluence() const { return coneOfInfluence_; }
+	void setConeOfInfluence(bool value) { coneOfInfluence_ = value; }
 };
 
 } // namespace trench
@@ -11,45 +11,368 @@
 
 #include <trench/config.h>
 
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
 #include <boost/unordered_set.hpp>
 
 #include "Benchmarking.h"
 
 namespace trench {
 
+/**
+ * Reference of a frame of Dfs to its state.
+ *
+ * In general, the set of visited states cannot give the states back (think of
+ * bitstate hashing or hash compaction), so the frame keeps a copy of the state.
+ */
+template<class State, class StateSet>
+class DfsStateReference {
+	State state_;
+
+public:
+	template<class Position>
+	DfsStateReference(const State &state, const Position &): state_(state) {}
+
+	const State &get() const { return state_; }
+};
+
+/**
+ * An unordered set of states keeps them at fixed addresses, so the frame only points to its state in the set.
+ */
+template<class State, class Hash, class Pred, class Alloc>
+class DfsStateReference<State, boost::unordered_set<State, Hash, Pred, Alloc>> {
+	const State *state_;
+
+public:
+	template<class Position>
+	DfsStateReference(const State &, const Position &position): state_(&*position) {}
+
+	const State &get() const { return *state_; }
+};
+
+/**
+ * Depth-first search over an automaton.
+ *
+ * The search is iterative: instead of the native stack it uses an explicit
+ * stack of frames, one per state on the current path. A frame keeps a reference
+ * to the state, which is only a pointer into the set of visited states if the set
+ * keeps the states, and a cursor telling which of its outgoing transitions is to be
+ * computed next.
+ * Transitions are computed lazily, one at a time, so nothing is computed after
+ * the visitor has stopped the search. The depth of the search is bounded only
+ * by the available heap memory.
+ */
 template<class Automaton, class Visitor, class StateSet = boost::unordered_set<typename Automaton::State>>
 class Dfs {
 	const Automaton &automaton_;
 	StateSet visited_;
 	Visitor visitor_;
 
+	struct Frame {
+		DfsStateReference<typename Automaton::State, StateSet> state;
+		typename Automaton::TransitionCursor cursor;
+	};
+
+	std::vector<Frame> stack_;
+	typename Automaton::Transition transition_;
+
 public:
-	Dfs(const Automaton &automaton, Visitor visitor): automaton_(automaton), visitor_(visitor) {}
+	Dfs(const Automaton &automaton, Visitor visitor, StateSet visited = StateSet()):
+		automaton_(automaton), visited_(std::move(visited)), visitor_(visitor)
+	{}
 
 	~Dfs() {
 		Statistics::instance().incVisitedStatesCount(visited_.size());
 	}
 
+	/**
+	 * Visits all the states reachable from the given one and not visited before.
+	 *
+	 * \return True if the visitor has stopped the search, false otherwise.
+	 */
 	bool visit(const typename Automaton::State &state) {
-		if (!visited_.insert(state).second) {
+		if (enter(state)) {
+			return abort();
+		}
+
+		while (!stack_.empty()) {
+			auto &frame = stack_.back();
+			const auto &source = frame.state.get();
+
+			if (automaton_.getNextTransition(source, frame.cursor, transition_)) {
+				if (visitor_.onTransition(source, transition_)) {
+					return abort();
+				}
+				if (enter(automaton_.getDestinationState(transition_))) {
+					return abort();
+				}
+			} else {
+				if (visitor_.onStateExit(source)) {
+					return abort();
+				}
+				stack_.pop_back();
+			}
+		}
+
+		return false;
+	}
+
+private:
+	/**
+	 * Enters the state, pushing a frame for it, unless it was visited before.
+	 *
+	 * \return True if the visitor has stopped the search, false otherwise.
+	 */
+	bool enter(const typename Automaton::State &state) {
+		auto inserted = visited_.insert(state);
+		if (!inserted.second) {
 			return false;
 		}
 		if (visitor_.onStateEnter(state)) {
 			return true;
 		}
-		for (const auto &transition : automaton_.getTransitionsFrom(state)) {
-			if (visitor_.onTransition(transition)) {
-				return true;
+		stack_.push_back(Frame{{state, inserted.first}, automaton_.getTransitionsFrom(state)});
+		return false;
+	}
+
+	bool abort() {
+		stack_.clear();
+		return true;
+	}
+};
+
+/**
+ * Depth-first search changing a single state in place.
+ *
+ * Instead of keeping a copy of each state on the current path, the search keeps
+ * only the current state. Transitions are applied to it in place, the changes being
+ * recorded into an undo log, and undone when the search backtracks. Only the states
+ * inserted into the set of visited states get copied (or fingerprinted) by the set.
+ *
+ * The automaton must provide applyNextTransition() and UndoLog. As the source state
+ * is gone once a transition is applied, the visitor's onTransition() is not called.
+ */
+template<class Automaton, class Visitor, class StateSet = boost::unordered_set<typename Automaton::State>>
+class InPlaceDfs {
+	const Automaton &automaton_;
+	StateSet visited_;
+	Visitor visitor_;
+
+	struct Frame {
+		typename Automaton::TransitionCursor cursor;
+
+		/** Undo-log mark taken before the transition leading to this frame's state. */
+		typename Automaton::UndoLog::Mark mark;
+	};
+
+	std::vector<Frame> stack_;
+	typename Automaton::State state_;
+	typename Automaton::UndoLog log_;
+
+public:
+	InPlaceDfs(const Automaton &automaton, Visitor visitor, StateSet visited = StateSet()):
+		automaton_(automaton), visited_(std::move(visited)), visitor_(visitor)
+	{}
+
+	~InPlaceDfs() {
+		Statistics::instance().incVisitedStatesCount(visited_.size());
+	}
+
+	/**
+	 * Visits all the states reachable from the given one and not visited before.
+	 *
+	 * \return True if the visitor has stopped the search, false otherwise.
+	 */
+	bool visit(const typename Automaton::State &state) {
+		state_ = state;
+		if (!enter()) {
+			return false;
+		}
+		if (visitor_.onStateEnter(state_)) {
+			return abort();
+		}
+		stack_.push_back(Frame{automaton_.getTransitionsFrom(state_), log_.mark(state_)});
+
+		while (!stack_.empty()) {
+			auto mark = log_.mark(state_);
+
+			if (automaton_.applyNextTransition(state_, stack_.back().cursor, log_)) {
+				if (enter()) {
+					if (visitor_.onStateEnter(state_)) {
+						return abort();
+					}
+					stack_.push_back(Frame{automaton_.getTransitionsFrom(state_), mark});
+				} else {
+					log_.undo(state_, mark);
+				}
+			} else {
+				if (visitor_.onStateExit(state_)) {
+					return abort();
+				}
+				log_.undo(state_, stack_.back().mark);
+				stack_.pop_back();
 			}
-			if (visit(automaton_.getDestinationState(transition))) {
-				return true;
+		}
+
+		return false;
+	}
+
+private:
+	bool enter() {
+		return visited_.insert(state_).second;
+	}
+
+	bool abort() {
+		if (!stack_.empty()) {
+			log_.undo(state_, stack_.front().mark);
+		}
+		stack_.clear();
+		return true;
+	}
+};
+
+/**
+ * Depth-first search pruning transitions with sleep sets.
+ *
+ * A transition explored from a state is put to sleep in the subtrees of the
+ * transitions explored from the same state after it, for as long as only
+ * transitions independent from it are executed: interleavings where it
+ * fires later are equivalent to those where it fires first. All reachable
+ * states are still visited.
+ *
+ * Each visited state is stored with the sleep set it was first entered with.
+ * When it is reached again with a sleep set lacking some of those transitions,
+ * they are explored from it now and removed from the stored set.
+ *
+ * The automaton must provide TransitionId, getTransitionId() and areIndependent().
+ */
+template<class Automaton, class Visitor>
+class SleepSetDfs {
+	typedef typename Automaton::State State;
+	typedef typename Automaton::TransitionId TransitionId;
+
+	/** Sorted vector of transition ids. */
+	typedef std::vector<TransitionId> SleepSet;
+
+	const Automaton &automaton_;
+	boost::unordered_map<State, SleepSet> visited_;
+	Visitor visitor_;
+
+	struct Frame {
+		State state;
+		typename Automaton::TransitionCursor cursor;
+
+		/** Transitions not to be explored: the sleep set the state was entered with and the explored ones. */
+		SleepSet sleep;
+
+		/** Whether the state was visited before, in which case only the transitions in awake are explored. */
+		bool revisit;
+		SleepSet awake;
+	};
+
+	std::vector<Frame> stack_;
+	typename Automaton::Transition transition_;
+	std::size_t prunedTransitionsCount_;
+
+public:
+	SleepSetDfs(const Automaton &automaton, Visitor visitor):
+		automaton_(automaton), visitor_(visitor), prunedTransitionsCount_(0)
+	{}
+
+	~SleepSetDfs() {
+		Statistics::instance().incVisitedStatesCount(visited_.size());
+		Statistics::instance().incSleepSetPrunedTransitionsCount(prunedTransitionsCount_);
+	}
+
+	/**
+	 * Visits all the states reachable from the given one and not visited before.
+	 *
+	 * \return True if the visitor has stopped the search, false otherwise.
+	 */
+	bool visit(const State &state) {
+		if (enter(state, SleepSet())) {
+			return abort();
+		}
+
+		while (!stack_.empty()) {
+			auto &frame = stack_.back();
+
+			if (automaton_.getNextTransition(frame.state, frame.cursor, transition_)) {
+				auto id = automaton_.getTransitionId(transition_);
+				bool asleep = std::binary_search(frame.sleep.begin(), frame.sleep.end(), id);
+				if (frame.revisit ? !std::binary_search(frame.awake.begin(), frame.awake.end(), id) : asleep) {
+					if (asleep) {
+						++prunedTransitionsCount_;
+					}
+					continue;
+				}
+
+				if (visitor_.onTransition(frame.state, transition_)) {
+					return abort();
+				}
+
+				SleepSet sleep;
+				for (auto sleeping : frame.sleep) {
+					if (automaton_.areIndependent(sleeping, id)) {
+						sleep.push_back(sleeping);
+					}
+				}
+				frame.sleep.insert(std::lower_bound(frame.sleep.begin(), frame.sleep.end(), id), id);
+
+				if (enter(automaton_.getDestinationState(transition_), std::move(sleep))) {
+					return abort();
+				}
+			} else {
+				if (!frame.revisit && visitor_.onStateExit(frame.state)) {
+					return abort();
+				}
+				stack_.pop_back();
 			}
 		}
-		if (visitor_.onStateExit(state)) {
-			return true;
+
+		return false;
+	}
+
+private:
+	/**
+	 * Enters the state with the given sleep set, pushing a frame if anything is to be explored from it.
+	 *
+	 * \return True if the visitor has stopped the search, false otherwise.
+	 */
+	bool enter(const State &state, SleepSet sleep) {
+		auto i = visited_.find(state);
+		if (i == visited_.end()) {
+			visited_.emplace(state, sleep);
+			if (visitor_.onStateEnter(state)) {
+				return true;
+			}
+			stack_.push_back(Frame{state, automaton_.getTransitionsFrom(state), std::move(sleep), false, SleepSet()});
+		} else {
+			auto &stored = i->second;
+
+			SleepSet awake;
+			std::set_difference(stored.begin(), stored.end(), sleep.begin(), sleep.end(), std::back_inserter(awake));
+			if (awake.empty()) {
+				return false;
+			}
+
+			SleepSet intersection;
+			std::set_intersection(stored.begin(), stored.end(), sleep.begin(), sleep.end(), std::back_inserter(intersection));
+			stored = std::move(intersection);
+
+			stack_.push_back(Frame{state, automaton_.getTransitionsFrom(state), std::move(sleep), true, std::move(awake)});
 		}
 		return false;
 	}
+
+	bool abort() {
+		stack_.clear();
+		return true;
+	}
 };
 
 template<class Automaton>
@@ -57,7 +380,7 @@ class EmptyDfsVisitor {
 public:
 	bool onStateEnter(const typename Automaton::State &) const { return false; }
 	bool onStateExit(const typename Automaton::State &) const { return false; }
-	bool onTransition(const typename Automaton::Transition &) const { return false; }
+	bool onTransition(const typename Automaton::State &, const typename Automaton::Transition &) const { return false; }
 };
 
 template<class Automaton, class Visitor = EmptyDfsVisitor<Automaton>>
@@ -0,0 +1,299 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <trench/config.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "Benchmarking.h"
+
+namespace trench {
+
+/**
+ * Stateless search with dynamic partial order reduction.
+ *
+ * The search keeps no set of visited states, only the current execution as a stack
+ * of frames and the current state, which is changed in place and restored from an undo
+ * log on backtracking. The memory needed is proportional to the depth of the search.
+ * The state space must be acyclic, otherwise the search does not terminate.
+ *
+ * From each state, only the threads in its backtrack set are explored. Initially, it
+ * holds a single thread. A thread gets added to the backtrack set of an earlier state
+ * when one of its transitions is dependent with the transition executed from that state
+ * and does not happen after it (Flanagan and Godefroid). The happens-before relation is
+ * tracked with vector clocks. Disabled transitions are checked too, so that threads
+ * blocked by others are accounted for. Sleep sets prune transitions whose
+ * interleavings have been explored already.
+ *
+ * All maximal executions are explored up to the order of independent transitions,
+ * so a final state is found if one is reachable, provided that no transition leads
+ * from a final state to a non-final one. As the number of such executions can be
+ * much larger than the number of states, the search can be given a limit on the
+ * number of states it visits.
+ *
+ * The automaton must provide threadsCount(), getTransitionsFrom(state, thread),
+ * getThreadTransitionsCount(), getThreadTransitionId(), getTransitionId(cursor),
+ * areIndependent(), and, like for InPlaceDfs, applyNextTransition() and UndoLog.
+ */
+template<class Automaton>
+class StatelessDpor {
+	typedef typename Automaton::State State;
+	typedef typename Automaton::TransitionCursor TransitionCursor;
+	typedef typename Automaton::TransitionId TransitionId;
+	typedef typename Automaton::UndoLog UndoLog;
+
+	/** Numbers of the transitions of each thread which happened before a transition. */
+	typedef std::vector<uint32_t> Clock;
+
+	/** Sorted vector of transition ids. */
+	typedef std::vector<TransitionId> SleepSet;
+
+	static const std::size_t NO_THREAD = static_cast<std::size_t>(-1);
+
+	struct Event {
+		std::size_t thread;
+		TransitionId id;
+		Clock clock;
+	};
+
+	struct Frame {
+		/** Taken before the event of the previous frame, which it undoes. */
+		typename UndoLog::Mark mark;
+
+		/** Threads having enabled transitions in the state. */
+		std::vector<bool> enabled;
+
+		/** Threads to be explored and those explored already. */
+		std::vector<bool> backtrack;
+		std::vector<bool> done;
+
+		SleepSet sleep;
+
+		/** Clocks of the last transitions of each thread. */
+		std::vector<Clock> clocks;
+
+		/** Thread being explored, or NO_THREAD. */
+		std::size_t thread;
+		TransitionCursor cursor;
+
+		/** Transition leading to the state of the next frame. */
+		Event event;
+	};
+
+	const Automaton &automaton_;
+	std::vector<Frame> stack_;
+	State state_;
+	UndoLog log_;
+
+	std::size_t statesCount_;
+	std::size_t prunedTransitionsCount_;
+
+	std::size_t maxStatesCount_;
+	bool complete_;
+
+public:
+	/**
+	 * \param automaton      Automaton with an acyclic state space.
+	 * \param maxStatesCount Number of states after which the search gives up, zero if unlimited.
+	 */
+	explicit
+	StatelessDpor(const Automaton &automaton, std::size_t maxStatesCount = 0):
+		automaton_(automaton), statesCount_(0), prunedTransitionsCount_(0),
+		maxStatesCount_(maxStatesCount), complete_(true)
+	{}
+
+	~StatelessDpor() {
+		Statistics::instance().incVisitedStatesCount(statesCount_);
+		Statistics::instance().incSleepSetPrunedTransitionsCount(prunedTransitionsCount_);
+	}
+
+	/**
+	 * \return True if a final state is reachable from the initial one. False if it is not,
+	 *         or if the search has given up, which isComplete() tells.
+	 */
+	bool run() {
+		auto nthreads = automaton_.threadsCount();
+
+		state_ = automaton_.initialState();
+		if (enter(log_.mark(state_), SleepSet(), std::vector<Clock>(nthreads, Clock(nthreads)))) {
+			return abort();
+		}
+
+		while (!stack_.empty()) {
+			auto &frame = stack_.back();
+
+			if (frame.thread == NO_THREAD) {
+				for (std::size_t thread = 0; thread < nthreads; ++thread) {
+					if (frame.backtrack[thread] && !frame.done[thread]) {
+						frame.done[thread] = true;
+						frame.thread = thread;
+						frame.cursor = automaton_.getTransitionsFrom(state_, thread);
+						break;
+					}
+				}
+				if (frame.thread == NO_THREAD) {
+					log_.undo(state_, frame.mark);
+					stack_.pop_back();
+					continue;
+				}
+			}
+
+			auto mark = log_.mark(state_);
+			if (!automaton_.applyNextTransition(state_, frame.cursor, log_)) {
+				frame.thread = NO_THREAD;
+				continue;
+			}
+
+			auto id = automaton_.getTransitionId(frame.cursor);
+			if (std::binary_search(frame.sleep.begin(), frame.sleep.end(), id)) {
+				++prunedTransitionsCount_;
+				log_.undo(state_, mark);
+				continue;
+			}
+
+			auto thread = frame.thread;
+
+			/* The transition happens after the dependent transitions executed before it. */
+			auto clock = frame.clocks[thread];
+			++clock[thread];
+			for (std::size_t i = 0; i + 1 < stack_.size(); ++i) {
+				const auto &event = stack_[i].event;
+				if (event.thread != thread && !automaton_.areIndependent(event.id, id)) {
+					for (std::size_t j = 0; j < nthreads; ++j) {
+						clock[j] = std::max(clock[j], event.clock[j]);
+					}
+				}
+			}
+
+			SleepSet sleep;
+			for (auto sleeping : frame.sleep) {
+				if (automaton_.areIndependent(sleeping, id)) {
+					sleep.push_back(sleeping);
+				}
+			}
+			frame.sleep.insert(std::lower_bound(frame.sleep.begin(), frame.sleep.end(), id), id);
+
+			auto clocks = frame.clocks;
+			clocks[thread] = clock;
+			frame.event = Event{thread, id, std::move(clock)};
+
+			if (enter(mark, std::move(sleep), std::move(clocks))) {
+				return abort();
+			}
+		}
+
+		return false;
+	}
+
+	/**
+	 * \return False if the search has given up after visiting too many states, true otherwise.
+	 */
+	bool isComplete() const { return complete_; }
+
+private:
+	/**
+	 * Pushes a frame for the current state.
+	 *
+	 * \return True if the search must stop, either because the state is final,
+	 *         or because the search gives up, false otherwise.
+	 */
+	bool enter(typename UndoLog::Mark mark, SleepSet sleep, std::vector<Clock> clocks) {
+		++statesCount_;
+		if (automaton_.isFinal(state_)) {
+			return true;
+		}
+		if (maxStatesCount_ != 0 && statesCount_ > maxStatesCount_) {
+			complete_ = false;
+			return true;
+		}
+
+		auto nthreads = automaton_.threadsCount();
+
+		Frame frame;
+		frame.mark = mark;
+		frame.enabled.resize(nthreads);
+		frame.backtrack.resize(nthreads);
+		frame.done.resize(nthreads);
+		frame.sleep = std::move(sleep);
+		frame.clocks = std::move(clocks);
+		frame.thread = NO_THREAD;
+
+		/* Start with a thread having an enabled transition which is not asleep. */
+		bool started = false;
+		for (std::size_t thread = 0; thread < nthreads; ++thread) {
+			auto cursor = automaton_.getTransitionsFrom(state_, thread);
+			auto before = log_.mark(state_);
+			while (automaton_.applyNextTransition(state_, cursor, log_)) {
+				log_.undo(state_, before);
+				frame.enabled[thread] = true;
+				if (!std::binary_search(frame.sleep.begin(), frame.sleep.end(), automaton_.getTransitionId(cursor))) {
+					if (!started) {
+						frame.backtrack[thread] = true;
+						started = true;
+					}
+					break;
+				}
+			}
+		}
+
+		stack_.push_back(std::move(frame));
+		addBacktrackPoints();
+		return false;
+	}
+
+	/**
+	 * For each transition of each thread going from the current state, finds the last
+	 * transition on the stack which it is dependent with and which does not happen before
+	 * the thread's last transition, and makes sure that the thread, or all the threads if
+	 * this one is disabled there, will be explored from the state before that transition.
+	 */
+	void addBacktrackPoints() {
+		const auto &clocks = stack_.back().clocks;
+
+		for (std::size_t thread = 0; thread < automaton_.threadsCount(); ++thread) {
+			for (std::size_t index = 0, count = automaton_.getThreadTransitionsCount(state_, thread); index < count; ++index) {
+				auto id = automaton_.getThreadTransitionId(state_, thread, index);
+
+				for (std::size_t i = stack_.size() - 1; i-- > 0; ) {
+					const auto &event = stack_[i].event;
+					if (event.thread == thread || event.clock[event.thread] <= clocks[thread][event.thread]) {
+						continue;
+					}
+					if (!automaton_.areIndependent(event.id, id)) {
+						auto &frame = stack_[i];
+						if (frame.enabled[thread]) {
+							frame.backtrack[thread] = true;
+						} else {
+							for (std::size_t other = 0; other < frame.enabled.size(); ++other) {
+								if (frame.enabled[other]) {
+									frame.backtrack[other] = true;
+								}
+							}
+						}
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	bool abort() {
+		if (!stack_.empty()) {
+			log_.undo(state_, stack_.front().mark);
+		}
+		stack_.clear();
+		return complete_;
+	}
+};
+
+} // namespace trench
@@ -0,0 +1,378 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <trench/config.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <boost/unordered_set.hpp>
+
+#include "Benchmarking.h"
+
+namespace trench {
+
+/**
+ * Temporary file of states, written and then read sequentially.
+ *
+ * A state is stored as its hash, its size and its bytes. The state type must
+ * provide bytes(), hash() and a constructor from a vector of bytes and a hash.
+ * The file is deleted when closed.
+ */
+template<class State>
+class StateFile {
+	std::unique_ptr<std::FILE, int (*)(std::FILE *)> file_;
+	std::size_t size_;
+
+public:
+	StateFile(): file_(std::tmpfile(), &std::fclose), size_(0) {
+		if (!file_) {
+			throw std::runtime_error("can't create a temporary file");
+		}
+	}
+
+	void write(const State &state) {
+		uint64_t hash = state.hash();
+		uint32_t size = static_cast<uint32_t>(state.bytes().size());
+		if (std::fwrite(&hash, sizeof(hash), 1, file_.get()) != 1 ||
+		    std::fwrite(&size, sizeof(size), 1, file_.get()) != 1 ||
+		    (size > 0 && std::fwrite(state.bytes().data(), size, 1, file_.get()) != 1)) {
+			throw std::runtime_error("can't write to a temporary file");
+		}
+		++size_;
+	}
+
+	/**
+	 * Makes the next read() return the first state in the file.
+	 */
+	void rewind() {
+		std::fflush(file_.get());
+		std::rewind(file_.get());
+	}
+
+	/**
+	 * Reads the next state.
+	 *
+	 * \return True on success, false at the end of the file.
+	 */
+	bool read(State &state) {
+		uint64_t hash;
+		uint32_t size;
+		if (std::fread(&hash, sizeof(hash), 1, file_.get()) != 1) {
+			return false;
+		}
+		std::vector<unsigned char> bytes;
+		if (std::fread(&size, sizeof(size), 1, file_.get()) == 1) {
+			bytes.resize(size);
+			if (size == 0 || std::fread(bytes.data(), size, 1, file_.get()) == 1) {
+				state = State(std::move(bytes), hash);
+				return true;
+			}
+		}
+		throw std::runtime_error("can't read from a temporary file");
+	}
+
+	/** Number of states written. */
+	std::size_t size() const { return size_; }
+};
+
+/**
+ * Breadth-first search in external memory.
+ *
+ * The visited states are kept in an in-memory hash table until it exceeds
+ * its share of the memory budget. Then the table is sorted and written out
+ * to a file as a run, and emptied. The levels of the search are kept in files
+ * too. Duplicates are detected with delay: the successors of a level that are
+ * not in the hash table are collected into a second hash table, which is also
+ * written out in sorted runs when it grows too big. Once the whole level has
+ * been expanded, the runs of successors are merged and the result is checked
+ * against the runs of visited states in a single sequential pass. Too many runs
+ * of visited states get merged into one.
+ *
+ * As long as nothing has been written out, the search does no file input
+ * or output, except for keeping the levels.
+ */
+template<class Automaton>
+class ExternalBfs {
+	typedef typename Automaton::State State;
+	typedef StateFile<State> Run;
+
+	/** Number of runs of visited states beyond which they are merged. */
+	static const std::size_t MAX_RUNS = 16;
+
+	const Automaton &automaton_;
+	std::size_t memoryLimit_;
+
+	/** Visited states not written out yet and the memory they take. */
+	boost::unordered_set<State> visited_;
+	std::size_t visitedMemory_;
+	std::vector<std::unique_ptr<Run>> visitedRuns_;
+
+	/** Successors of the current level not known to be visited and the memory they take. */
+	boost::unordered_set<State> successors_;
+	std::size_t successorsMemory_;
+	std::vector<std::unique_ptr<Run>> successorRuns_;
+
+	std::size_t statesCount_;
+	std::size_t spilledStatesCount_;
+
+public:
+	/**
+	 * \param automaton   Automaton.
+	 * \param memoryLimit Approximate number of bytes the hash tables may take.
+	 */
+	ExternalBfs(const Automaton &automaton, std::size_t memoryLimit):
+		automaton_(automaton), memoryLimit_(memoryLimit),
+		visitedMemory_(0), successorsMemory_(0), statesCount_(0), spilledStatesCount_(0)
+	{}
+
+	~ExternalBfs() {
+		Statistics::instance().incVisitedStatesCount(statesCount_);
+		Statistics::instance().incSpilledStatesCount(spilledStatesCount_);
+	}
+
+	/**
+	 * \return True if a final state is reachable from the initial one, false otherwise.
+	 */
+	bool run() {
+		auto initialState = automaton_.initialState();
+		if (automaton_.isFinal(initialState)) {
+			Statistics::instance().addWitnessLength(0);
+			return true;
+		}
+
+		auto level = std::make_unique<Run>();
+		visit(initialState, *level);
+
+		State state;
+		typename Automaton::Transition transition;
+
+		for (std::size_t depth = 1; level->size() > 0; ++depth) {
+			level->rewind();
+			while (level->read(state)) {
+				auto cursor = automaton_.getTransitionsFrom(state);
+				while (automaton_.getNextTransition(state, cursor, transition)) {
+					const auto &destination = automaton_.getDestinationState(transition);
+					if (visited_.find(destination) == visited_.end()) {
+						addSuccessor(destination);
+					}
+				}
+			}
+
+			auto next = std::make_unique<Run>();
+			if (visitSuccessors(*next)) {
+				Statistics::instance().addWitnessLength(depth);
+				return true;
+			}
+			level = std::move(next);
+
+			if (visitedRuns_.size() > MAX_RUNS) {
+				mergeVisitedRuns();
+			}
+		}
+
+		return false;
+	}
+
+private:
+	/**
+	 * \return Approximate number of bytes a state takes in a hash table.
+	 */
+	static std::size_t footprint(const State &state) {
+		return sizeof(State) + state.bytes().size() + 4 * sizeof(void *);
+	}
+
+	static bool less(const State *a, const State *b) {
+		if (a->hash() != b->hash()) {
+			return a->hash() < b->hash();
+		}
+		if (a->bytes().size() != b->bytes().size()) {
+			return a->bytes().size() < b->bytes().size();
+		}
+		return std::memcmp(a->bytes().data(), b->bytes().data(), a->bytes().size()) < 0;
+	}
+
+	/**
+	 * Writes the states of a hash table into a new run sorted by less().
+	 */
+	static std::unique_ptr<Run> writeRun(const boost::unordered_set<State> &states) {
+		std::vector<const State *> sorted;
+		sorted.reserve(states.size());
+		for (const auto &state : states) {
+			sorted.push_back(&state);
+		}
+		std::sort(sorted.begin(), sorted.end(), &less);
+
+		auto run = std::make_unique<Run>();
+		for (const State *state : sorted) {
+			run->write(*state);
+		}
+		run->rewind();
+		return run;
+	}
+
+	/**
+	 * Reader of a run, keeping the state read last.
+	 */
+	struct Cursor {
+		Run *run;
+		State state;
+		bool valid;
+
+		explicit
+		Cursor(Run &run): run(&run) { next(); }
+
+		void next() { valid = run->read(state); }
+	};
+
+	/**
+	 * Merges sorted runs into a sorted sequence without duplicates.
+	 *
+	 * \param runs Runs.
+	 * \param fun  Function called for each state in order, returning true to stop.
+	 *
+	 * \return True if fun has stopped the merge, false otherwise.
+	 */
+	template<class Function>
+	static bool merge(const std::vector<std::unique_ptr<Run>> &runs, Function fun) {
+		std::vector<Cursor> cursors;
+		for (const auto &run : runs) {
+			run->rewind();
+			cursors.push_back(Cursor(*run));
+		}
+
+		while (true) {
+			Cursor *min = nullptr;
+			for (auto &cursor : cursors) {
+				if (cursor.valid && (!min || less(&cursor.state, &min->state))) {
+					min = &cursor;
+				}
+			}
+			if (!min) {
+				return false;
+			}
+
+			State state = min->state;
+			for (auto &cursor : cursors) {
+				while (cursor.valid && cursor.state == state) {
+					cursor.next();
+				}
+			}
+
+			if (fun(state)) {
+				return true;
+			}
+		}
+	}
+
+	void visit(const State &state, Run &level) {
+		++statesCount_;
+		visitedMemory_ += footprint(state);
+		visited_.insert(state);
+		level.write(state);
+
+		if (visitedMemory_ > memoryLimit_ / 2) {
+			spillVisited();
+		}
+	}
+
+	void addSuccessor(const State &state) {
+		if (successors_.insert(state).second) {
+			successorsMemory_ += footprint(state);
+			if (successorsMemory_ > memoryLimit_ / 2) {
+				spillSuccessors();
+			}
+		}
+	}
+
+	void spillSuccessors() {
+		successorRuns_.push_back(writeRun(successors_));
+		successors_.clear();
+		successorsMemory_ = 0;
+	}
+
+	void spillVisited() {
+		spilledStatesCount_ += visited_.size();
+		visitedRuns_.push_back(writeRun(visited_));
+		visited_.clear();
+		visitedMemory_ = 0;
+	}
+
+	void mergeVisitedRuns() {
+		auto run = std::make_unique<Run>();
+		merge(visitedRuns_, [&run](const State &state) {
+			run->write(state);
+			return false;
+		});
+		visitedRuns_.clear();
+		visitedRuns_.push_back(std::move(run));
+	}
+
+	/**
+	 * Visits the successors of the current level which have not been visited before.
+	 *
+	 * The runs of visited states written out meanwhile contain none of the successors
+	 * still to be visited, so the pass over the older runs remains valid.
+	 *
+	 * \return True if one of them is final, false otherwise.
+	 */
+	bool visitSuccessors(Run &level) {
+		bool found = false;
+
+		if (visitedRuns_.empty() && successorRuns_.empty()) {
+			for (const auto &state : successors_) {
+				visit(state, level);
+				if (automaton_.isFinal(state)) {
+					found = true;
+					break;
+				}
+			}
+		} else {
+			if (!successors_.empty()) {
+				spillSuccessors();
+			}
+
+			std::vector<Cursor> visited;
+			for (const auto &run : visitedRuns_) {
+				run->rewind();
+				visited.push_back(Cursor(*run));
+			}
+
+			/* Both the successors and each run of visited states are sorted, so a single pass suffices. */
+			found = merge(successorRuns_, [&](const State &state) {
+				for (auto &cursor : visited) {
+					while (cursor.valid && less(&cursor.state, &state)) {
+						cursor.next();
+					}
+					if (cursor.valid && cursor.state == state) {
+						return false;
+					}
+				}
+				visit(state, level);
+				return automaton_.isFinal(state);
+			});
+		}
+
+		successors_.clear();
+		successorsMemory_ = 0;
+		successorRuns_.clear();
+
+		return found;
+	}
+};
+
+} // namespace trench
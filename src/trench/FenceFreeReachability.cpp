@@ -0,0 +1,161 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#include "FenceFreeReachability.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "Instruction.h"
+#include "State.h"
+#include "Thread.h"
+#include "Transition.h"
+
+namespace trench {
+
+FenceFreeReachability::FenceFreeReachability(const Thread *thread):
+	thread_(thread)
+{
+	const auto &states = thread->states();
+	for (std::size_t id = 0; id < states.size(); ++id) {
+		state2id_[states[id]] = id;
+	}
+	words_ = (states.size() + 63) / 64;
+
+	successors_.assign(states.size() * words_, 0);
+	for (const Transition *transition : thread->transitions()) {
+		switch (transition->instruction()->mnemonic()) {
+			case Instruction::READ:
+			case Instruction::WRITE:
+			case Instruction::LOCAL:
+			case Instruction::CONDITION:
+			case Instruction::NOOP:
+				set(&successors_[getId(transition->from()) * words_], getId(transition->to()));
+				break;
+			case Instruction::MFENCE:
+			case Instruction::LOCK:
+			case Instruction::UNLOCK:
+				break;
+			default: {
+				assert(!"NEVER REACHED");
+			}
+		}
+	}
+
+	/* Warshall's algorithm, a whole row at a time. */
+	closure_ = successors_;
+	for (std::size_t id = 0; id < states.size(); ++id) {
+		set(&closure_[id * words_], id);
+	}
+	for (std::size_t k = 0; k < states.size(); ++k) {
+		const uint64_t *rowK = &closure_[k * words_];
+		for (std::size_t i = 0; i < states.size(); ++i) {
+			uint64_t *rowI = &closure_[i * words_];
+			if (i != k && test(rowI, k)) {
+				for (std::size_t word = 0; word < words_; ++word) {
+					rowI[word] |= rowK[word];
+				}
+			}
+		}
+	}
+}
+
+std::size_t FenceFreeReachability::getId(const State *state) const {
+	auto i = state2id_.find(state);
+	assert(i != state2id_.end());
+	return i->second;
+}
+
+FenceFreeReachability::StateSet FenceFreeReachability::makeStateSet(const boost::unordered_set<State *> &states) const {
+	StateSet result(words_, 0);
+	for (const State *state : states) {
+		auto i = state2id_.find(state);
+		if (i != state2id_.end()) {
+			set(&result[0], i->second);
+		}
+	}
+	return result;
+}
+
+bool FenceFreeReachability::isReachable(const State *state, const State *target, const StateSet &excluded) const {
+	std::size_t from = getId(state);
+	std::size_t to = getId(target);
+
+	if (from == to) {
+		return true;
+	}
+	if (!test(&closure_[from * words_], to)) {
+		return false;
+	}
+	return test(&computeReachable(from, excluded, to)[0], to);
+}
+
+std::vector<State *> FenceFreeReachability::getIntermediary(const State *state, const State *target) const {
+	std::vector<State *> result;
+
+	std::size_t from = getId(state);
+	std::size_t to = getId(target);
+
+	if (!test(&closure_[from * words_], to)) {
+		return result;
+	}
+
+	/* The paths end as soon as they reach the target. */
+	StateSet excluded(words_, 0);
+	set(&excluded[0], to);
+	auto reachable = computeReachable(from, excluded);
+
+	for (std::size_t word = 0; word < words_; ++word) {
+		for (uint64_t bits = reachable[word]; bits; bits &= bits - 1) {
+			std::size_t id = word * 64 + __builtin_ctzll(bits);
+			if (test(&closure_[id * words_], to)) {
+				result.push_back(thread_->states()[id]);
+			}
+		}
+	}
+
+	return result;
+}
+
+FenceFreeReachability::StateSet FenceFreeReachability::computeReachable(std::size_t from, const StateSet &excluded, std::size_t target) const {
+	StateSet reachable(words_, 0);
+	StateSet frontier(words_, 0);
+	StateSet next(words_, 0);
+
+	set(&reachable[0], from);
+	set(&frontier[0], from);
+
+	bool changed = true;
+	while (changed) {
+		std::fill(next.begin(), next.end(), 0);
+		for (std::size_t word = 0; word < words_; ++word) {
+			for (uint64_t bits = frontier[word] & ~excluded[word]; bits; bits &= bits - 1) {
+				const uint64_t *row = &successors_[(word * 64 + __builtin_ctzll(bits)) * words_];
+				for (std::size_t i = 0; i < words_; ++i) {
+					next[i] |= row[i];
+				}
+			}
+		}
+
+		changed = false;
+		for (std::size_t word = 0; word < words_; ++word) {
+			frontier[word] = next[word] & ~reachable[word];
+			reachable[word] |= frontier[word];
+			changed |= frontier[word] != 0;
+		}
+
+		if (target != NO_ID && test(&reachable[0], target)) {
+			break;
+		}
+	}
+
+	return reachable;
+}
+
+} // namespace trench
@@ -0,0 +1,97 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <trench/config.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
+namespace trench {
+
+class State;
+class Thread;
+
+/**
+ * Reachability between the control states of a thread by fence-free transitions,
+ * i.e. reads, writes, local assignments, conditions and no-ops.
+ *
+ * The control states are numbered as in Thread::states(), and sets of them are bitsets
+ * of words_ 64-bit words. The reflexive transitive closure is computed once, so that
+ * a query without extra fences is a single bit test.
+ */
+class FenceFreeReachability {
+	static const std::size_t NO_ID = static_cast<std::size_t>(-1);
+
+	const Thread *thread_;
+	boost::unordered_map<const State *, std::size_t> state2id_;
+	std::size_t words_;
+
+	/** Row i is the set of control states reachable from state i in one step. */
+	std::vector<uint64_t> successors_;
+
+	/** Row i is the set of control states reachable from state i in any number of steps. */
+	std::vector<uint64_t> closure_;
+
+public:
+	/**
+	 * Bitset of control states.
+	 */
+	typedef std::vector<uint64_t> StateSet;
+
+	explicit FenceFreeReachability(const Thread *thread);
+
+	const Thread *thread() const { return thread_; }
+
+	/**
+	 * \return Bitset of the given control states of the thread, others being ignored.
+	 */
+	StateSet makeStateSet(const boost::unordered_set<State *> &states) const;
+
+	/**
+	 * \return True if the target is reachable from the state.
+	 */
+	bool isReachable(const State *state, const State *target) const {
+		std::size_t from = getId(state);
+		std::size_t to = getId(target);
+		return test(&closure_[from * words_], to);
+	}
+
+	/**
+	 * \return True if the target is reachable from the state without leaving
+	 *         any of the excluded states, i.e. with fences inserted after them.
+	 */
+	bool isReachable(const State *state, const State *target, const StateSet &excluded) const;
+
+	/**
+	 * \return The control states lying on the paths from the state to the target
+	 *         not passing through the target before their end, the target included.
+	 *         Empty if the target is not reachable.
+	 */
+	std::vector<State *> getIntermediary(const State *state, const State *target) const;
+
+private:
+	std::size_t getId(const State *state) const;
+
+	static bool test(const uint64_t *row, std::size_t id) { return (row[id / 64] >> (id % 64)) & 1; }
+	static void set(uint64_t *row, std::size_t id) { row[id / 64] |= uint64_t(1) << (id % 64); }
+
+	/**
+	 * Computes the set of control states reachable from the state without leaving the excluded ones.
+	 * Unless the target is NO_ID, stops as soon as it is reached.
+	 */
+	StateSet computeReachable(std::size_t from, const StateSet &excluded, std::size_t target = NO_ID) const;
+};
+
+} // namespace trench
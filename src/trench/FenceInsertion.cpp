@@ -9,12 +9,18 @@
 
 #include "FenceInsertion.h"
 
+#include <memory>
+
 #include <boost/range/adaptor/map.hpp>
 #include <boost/unordered_map.hpp>
 #include <boost/unordered_set.hpp>
 
 #include "Benchmarking.h"
+#include "Configuration.h"
+#include "FenceFreeReachability.h"
 #include "Instruction.h"
+#include "MayAddresses.h"
+#include "OriginalStates.h"
 #include "Program.h"
 #include "RobustnessChecking.h"
 #include "SortAndUnique.h"
@@ -30,6 +36,8 @@ namespace {
 class Attack {
 	const Program &program_;
 	Thread *attacker_;
+	const FenceFreeReachability &reachability_;
+	const MayAddresses &addresses_;
 	Transition *write_;
 	Transition *read_;
 
@@ -38,13 +46,15 @@ class Attack {
 
 	public:
 
-	Attack(const Program &program, Thread *attacker, Transition *write, Transition *read):
-		program_(program), attacker_(attacker), write_(write), read_(read), feasible_(false)
+	Attack(const Program &program, Thread *attacker, const FenceFreeReachability &reachability, const MayAddresses &addresses, Transition *write, Transition *read):
+		program_(program), attacker_(attacker), reachability_(reachability), addresses_(addresses), write_(write), read_(read), feasible_(false)
 	{
 	}
 
 	const Program &program() const { return program_; }
 	Thread *attacker() const { return attacker_; }
+	const FenceFreeReachability &reachability() const { return reachability_; }
+	const MayAddresses &addresses() const { return addresses_; }
 	Transition *write() const { return write_; }
 	Transition *read() const { return read_; }
 
@@ -63,59 +73,36 @@ class Attack {
 class AttackChecker {
 	Attack &attack_;
 	bool searchForTdrOnly_;
+	const OriginalStates *originalStates_;
+
+	/** If not NULL, the writes and reads of the feasible attacks, known in advance. */
+	const AttackSet *feasibleAttacks_;
 
 	public:
 
-	AttackChecker(Attack &attack, bool searchForTdrOnly):
-		attack_(attack), searchForTdrOnly_(searchForTdrOnly)
+	AttackChecker(Attack &attack, bool searchForTdrOnly, const OriginalStates *originalStates, const AttackSet *feasibleAttacks):
+		attack_(attack), searchForTdrOnly_(searchForTdrOnly), originalStates_(originalStates), feasibleAttacks_(feasibleAttacks)
 	{}
 
 	void operator()() {
-		if (isAttackFeasible(attack_.program(), searchForTdrOnly_, attack_.attacker(), attack_.write(), attack_.read())) {
-			attack_.setFeasible(true);
-
-			boost::unordered_set<State *> visited;
-			boost::unordered_set<State *> intermediary;
-
-			dfs(attack_.write()->to(), attack_.read()->from(), visited, intermediary);
-
-			attack_.setIntermediary(intermediary);
-		}
-	}
-
-	private:
-
-	static void dfs(State *state, State *target, boost::unordered_set<State *> &visited, boost::unordered_set<State *> &intermediary) {
-		if (state == target) {
-			intermediary.insert(state);
-			return;
-		}
-
-		if (visited.find(state) != visited.end()) {
-			return;
-		}
+		/*
+		 * Feasible attacks are usually found quickly by a search with bitstate hashing,
+		 * which needs much less memory. The exact search is run only if it finds nothing.
+		 */
+		AttackCheckOptions options;
+		options.bitstateMemory = Configuration::instance().bitstateMemory();
+		options.originalStates = originalStates_;
+		options.reachability = &attack_.reachability();
+		options.addresses = &attack_.addresses();
+		options.feasibleAttacks = feasibleAttacks_;
 
-		visited.insert(state);
+		bool feasible = isAttackFeasible(attack_.program(), searchForTdrOnly_, attack_.attacker(), attack_.write(), attack_.read(),
+		                                 boost::unordered_set<State *>(), options);
 
-		for (Transition *transition : state->out()) {
-			switch (transition->instruction()->mnemonic()) {
-				case Instruction::READ:
-				case Instruction::WRITE:
-				case Instruction::LOCAL:
-				case Instruction::CONDITION:
-				case Instruction::NOOP:
-					dfs(transition->to(), target, visited, intermediary);
+		if (feasible) {
+			attack_.setFeasible(true);
 
-					if (intermediary.find(transition->to()) != intermediary.end()) {
-						intermediary.insert(state);
-					}
-					break;
-				case Instruction::MFENCE:
-					break;
-				default: {
-					assert(!"NEVER REACHED");
-				}
-			}
+			attack_.setIntermediary(attack_.reachability().getIntermediary(attack_.write()->to(), attack_.read()->from()));
 		}
 	}
 };
@@ -141,11 +128,12 @@ class Attacker {
 class AttackerNeutralizer {
 	Attacker &attacker_;
 	bool searchForTdrOnly_;
+	const OriginalStates *originalStates_;
 
 	public:
 
-	AttackerNeutralizer(Attacker &attacker, bool searchForTdrOnly):
-		attacker_(attacker), searchForTdrOnly_(searchForTdrOnly)
+	AttackerNeutralizer(Attacker &attacker, bool searchForTdrOnly, const OriginalStates *originalStates):
+		attacker_(attacker), searchForTdrOnly_(searchForTdrOnly), originalStates_(originalStates)
 	{}
 
 	void operator()() {
@@ -203,8 +191,13 @@ class AttackerNeutralizer {
 		if (usedFences.size() == nfences) {
 			bool success = true;
 			for (const Attack *attack : attacker_.attacks()) {
+				AttackCheckOptions options;
+				options.originalStates = originalStates_;
+				options.reachability = &attack->reachability();
+				options.addresses = &attack->addresses();
+
 				if (isAttackFeasible(attack->program(), searchForTdrOnly_,
-				    attack->attacker(), attack->write(), attack->read(), usedFences)) {
+				    attack->attacker(), attack->write(), attack->read(), usedFences, options)) {
 					success = false;
 					break;
 				}
@@ -235,7 +228,15 @@ class AttackerNeutralizer {
 FenceSet computeFences(const Program &program, bool searchForTdrOnly) {
 	std::vector<Attack> attacks;
 
+	/* Fence-free reachability within each thread, computed once for all its attacks. */
+	std::vector<std::unique_ptr<FenceFreeReachability>> reachabilities;
+
+	/* Addresses the program may access, for discarding attacks that cannot close a cycle. */
+	auto addresses = computeMayAddresses(program);
+
 	for (Thread *thread : program.threads()) {
+		reachabilities.emplace_back(new FenceFreeReachability(thread));
+
 		std::vector<Transition *> reads;
 		std::vector<Transition *> writes;
 
@@ -249,16 +250,27 @@ FenceSet computeFences(const Program &program, bool searchForTdrOnly) {
 
 		for (Transition *write : writes) {
 			for (Transition *read : reads) {
-				attacks.push_back(Attack(program, thread, write, read));
+				attacks.push_back(Attack(program, thread, *reachabilities.back(), addresses, write, read));
 			}
 		}
 	}
 
+	/* Until the attacker's first write, all the attacks run the same original code. */
+	std::unique_ptr<OriginalStates> originalStates;
+	if (Configuration::instance().originalStatesSharing()) {
+		originalStates.reset(new OriginalStates(program, Configuration::instance().originalStatesLimit()));
+	}
+
+	std::unique_ptr<AttackSet> feasibleAttacks;
+	if (Configuration::instance().jointAttackSearch()) {
+		feasibleAttacks.reset(new AttackSet(findFeasibleAttacks(program, searchForTdrOnly)));
+	}
+
 	{
 		ThreadPool<> pool;
 
 		for (Attack &attack : attacks) {
-			pool.schedule(AttackChecker(attack, searchForTdrOnly));
+			pool.schedule(AttackChecker(attack, searchForTdrOnly, originalStates.get(), feasibleAttacks.get()));
 		}
 	}
 
@@ -274,7 +286,7 @@ FenceSet computeFences(const Program &program, bool searchForTdrOnly) {
 		ThreadPool<> pool;
 
 		for (Attacker &attacker : thread2attacker | boost::adaptors::map_values) {
-			pool.schedule(AttackerNeutralizer(attacker, searchForTdrOnly));
+			pool.schedule(AttackerNeutralizer(attacker, searchForTdrOnly, originalStates.get()));
 		}
 	}
 
@@ -0,0 +1,109 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <trench/config.h>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+#include "Benchmarking.h"
+#include "HashMix.h"
+
+namespace trench {
+
+/**
+ * Set of states keeping only 64-bit fingerprints of the states (hash compaction).
+ *
+ * Fingerprints are stored in an open-addressing hash table with linear probing.
+ * Two different states with equal fingerprints are mistaken for one, so a search
+ * using this set can miss some states, but with 64-bit fingerprints this is
+ * very unlikely: the probability of a collision among n states is about n^2 / 2^65.
+ *
+ * The set mimics the insert() and size() methods of unordered sets,
+ * so that it can be used as the set of visited states of Dfs.
+ * On destruction, it reports the probability of a collision to Statistics.
+ */
+template<class T, class Hash = boost::hash<T>>
+class HashCompactionSet {
+	/** Table of fingerprints, zero marking an empty slot. Its size is a power of two. */
+	std::vector<uint64_t> table_;
+	std::size_t size_;
+
+public:
+	HashCompactionSet(): table_(1024), size_(0) {}
+
+	HashCompactionSet(HashCompactionSet &&) = default;
+
+	~HashCompactionSet() {
+		if (!table_.empty()) {
+			Statistics::instance().addHashCompactionStatistics(collisionProbability());
+		}
+	}
+
+	/**
+	 * Inserts an element into the set.
+	 *
+	 * \return A pair of the fingerprint of the element and a flag telling whether it was considered new.
+	 */
+	std::pair<uint64_t, bool> insert(const T &element) {
+		uint64_t fingerprint = mixHash(Hash()(element));
+		if (fingerprint == 0) {
+			fingerprint = 1;
+		}
+
+		if (2 * (size_ + 1) > table_.size()) {
+			grow();
+		}
+
+		return std::make_pair(fingerprint, place(table_, fingerprint));
+	}
+
+	std::size_t size() const { return size_; }
+
+	/**
+	 * \return Probability that two of the elements in the set have equal fingerprints.
+	 */
+	double collisionProbability() const {
+		/* 2^-65 */
+		return static_cast<double>(size_) * size_ / 36893488147419103232.0;
+	}
+
+private:
+	bool place(std::vector<uint64_t> &table, uint64_t fingerprint) {
+		uint64_t mask = table.size() - 1;
+		for (uint64_t i = fingerprint & mask; ; i = (i + 1) & mask) {
+			if (table[i] == fingerprint) {
+				return false;
+			}
+			if (table[i] == 0) {
+				table[i] = fingerprint;
+				++size_;
+				return true;
+			}
+		}
+	}
+
+	void grow() {
+		std::vector<uint64_t> table(table_.size() * 2);
+		size_ = 0;
+		for (uint64_t fingerprint : table_) {
+			if (fingerprint != 0) {
+				place(table, fingerprint);
+			}
+		}
+		table_.swap(table);
+	}
+};
+
+} // namespace trench
@@ -0,0 +1,55 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <trench/config.h>
+
+#include <cstdint>
+#include <cstring>
+
+namespace trench {
+
+/**
+ * Finalizer of SplitMix64: a bijection on 64-bit integers with good avalanche.
+ * Every bit of the input affects every bit of the output with probability about one half.
+ */
+inline uint64_t mixHash(uint64_t x) {
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+/**
+ * \return Pseudo-random 64-bit hash of a pair of 32-bit integers.
+ */
+inline uint64_t mixHash(uint32_t a, uint32_t b) {
+	return mixHash((static_cast<uint64_t>(a) << 32) | b);
+}
+
+/**
+ * \return Pseudo-random 64-bit hash of a byte string.
+ */
+inline uint64_t mixHash(const unsigned char *data, std::size_t size) {
+	uint64_t result = mixHash(size);
+	for (; size >= sizeof(uint64_t); data += sizeof(uint64_t), size -= sizeof(uint64_t)) {
+		uint64_t word;
+		std::memcpy(&word, data, sizeof(word));
+		result = mixHash(result ^ word);
+	}
+	if (size > 0) {
+		uint64_t word = 0;
+		std::memcpy(&word, data, size);
+		result = mixHash(result ^ word);
+	}
+	return result;
+}
+
+} // namespace trench
@@ -120,6 +120,11 @@ public:
 		addInstructions(std::forward<Ts>(instructions)...);
 	}
 
+	explicit
+	Atomic(std::vector<std::shared_ptr<Instruction>> instructions):
+		Instruction(ATOMIC), instructions_(std::move(instructions))
+	{}
+
 	const std::vector<std::shared_ptr<Instruction>> &instructions() const { return instructions_; }
 
 private:
@@ -11,6 +11,7 @@
 
 #include <boost/range/adaptor/reversed.hpp>
 
+#include "Census.h"
 #include "Program.h"
 #include "SortAndUnique.h"
 #include "State.h"
@@ -21,22 +22,22 @@ namespace trench {
 
 namespace {
 
-void computeKilledRegisters(const Instruction &instruction, std::vector<const Register *> &result) {
+void computeKilledRegisters(const Instruction &instruction, const Census &census, std::vector<std::size_t> &result) {
 	switch (instruction.mnemonic()) {
 		case Instruction::READ: {
 			auto read = instruction.as<Read>();
-			result.push_back(read->reg().get());
+			result.push_back(census.getId(read->reg().get()));
 			break;
 		}
 		case Instruction::LOCAL: {
 			auto local = instruction.as<Local>();
-			result.push_back(local->reg().get());
+			result.push_back(census.getId(local->reg().get()));
 			break;
 		}
 		case Instruction::ATOMIC: {
 			auto atomic = instruction.as<Atomic>();
 			for (const auto &instruction : atomic->instructions()) {
-				computeKilledRegisters(*instruction, result);
+				computeKilledRegisters(*instruction, census, result);
 			}
 			break;
 		}
@@ -46,21 +47,21 @@ void computeKilledRegisters(const Instruction &instruction, std::vector<const Re
 	}
 }
 
-void computeUsedRegisters(const Expression &expression, std::vector<const Register *> &result) {
+void computeUsedRegisters(const Expression &expression, const Census &census, std::vector<std::size_t> &result) {
 	switch (expression.kind()) {
 		case Expression::REGISTER: {
-			result.push_back(expression.as<Register>());
+			result.push_back(census.getId(expression.as<Register>()));
 			break;
 		}
 		case Expression::UNARY: {
 			auto unary = expression.as<UnaryOperator>();
-			computeUsedRegisters(*unary->operand(), result);
+			computeUsedRegisters(*unary->operand(), census, result);
 			break;
 		}
 		case Expression::BINARY: {
 			auto binary = expression.as<BinaryOperator>();
-			computeUsedRegisters(*binary->left(), result);
-			computeUsedRegisters(*binary->right(), result);
+			computeUsedRegisters(*binary->left(), census, result);
+			computeUsedRegisters(*binary->right(), census, result);
 			break;
 		}
 		default: {
@@ -69,45 +70,45 @@ void computeUsedRegisters(const Expression &expression, std::vector<const Regist
 	}
 }
 
-void computeUsedRegisters(const Instruction &instruction, std::vector<const Register *> &result) {
+void computeUsedRegisters(const Instruction &instruction, const Census &census, std::vector<std::size_t> &result) {
 	switch (instruction.mnemonic()) {
 		case Instruction::READ: {
 			auto read = instruction.as<Read>();
-			computeUsedRegisters(*read->address(), result);
+			computeUsedRegisters(*read->address(), census, result);
 			break;
 		}
 		case Instruction::WRITE: {
 			auto write = instruction.as<Write>();
-			computeUsedRegisters(*write->address(), result);
-			computeUsedRegisters(*write->value(), result);
+			computeUsedRegisters(*write->address(), census, result);
+			computeUsedRegisters(*write->value(), census, result);
 			break;
 		}
 		case Instruction::LOCAL: {
 			auto local = instruction.as<Local>();
-			computeUsedRegisters(*local->value(), result);
+			computeUsedRegisters(*local->value(), census, result);
 			break;
 		}
 		case Instruction::CONDITION: {
 			auto condition = instruction.as<Condition>();
-			computeUsedRegisters(*condition->expression(), result);
+			computeUsedRegisters(*condition->expression(), census, result);
 			break;
 		}
 		case Instruction::ATOMIC: {
 			auto atomic = instruction.as<Atomic>();
 
-			std::vector<const Register *> usedAndNotKilled;
+			std::vector<std::size_t> usedAndNotKilled;
 			for (const auto &transition : boost::adaptors::reverse(atomic->instructions())) {
-				std::vector<const Register *> killed;
-				computeKilledRegisters(*transition, killed);
+				std::vector<std::size_t> killed;
+				computeKilledRegisters(*transition, census, killed);
 
 				usedAndNotKilled.erase(
 					std::remove_if(
 						usedAndNotKilled.begin(),
 						usedAndNotKilled.end(),
-						[&](const Register *reg){ return std::find(killed.begin(), killed.end(), reg) != killed.end(); }),
+						[&](std::size_t reg){ return std::find(killed.begin(), killed.end(), reg) != killed.end(); }),
 					usedAndNotKilled.end());
 
-				computeUsedRegisters(*transition, usedAndNotKilled);
+				computeUsedRegisters(*transition, census, usedAndNotKilled);
 			}
 
 			result.insert(result.end(), usedAndNotKilled.begin(), usedAndNotKilled.end());
@@ -119,35 +120,51 @@ void computeUsedRegisters(const Instruction &instruction, std::vector<const Regi
 	}
 }
 
-void computeLiveness(const Thread &thread, Liveness &liveness) {
+void computeLiveness(std::size_t thread, const Census &census, Liveness &liveness) {
+	const auto &states = census.states(thread);
+
+	/* Registers killed and used by each transition, indexed like State::out(). */
+	std::vector<std::vector<std::vector<std::size_t>>> killedRegisters(states.size());
+	std::vector<std::vector<std::vector<std::size_t>>> usedRegisters(states.size());
+
+	for (std::size_t state = 0; state < states.size(); ++state) {
+		for (const Transition *transition : states[state]->out()) {
+			killedRegisters[state].push_back(std::vector<std::size_t>());
+			computeKilledRegisters(*transition->instruction(), census, killedRegisters[state].back());
+
+			usedRegisters[state].push_back(std::vector<std::size_t>());
+			computeUsedRegisters(*transition->instruction(), census, usedRegisters[state].back());
+		}
+	}
+
 	bool changed;
 	do {
 		changed = false;
 
-		for (const State *state : thread.states()) {
-			std::vector<const Register *> liveAtState;
-
-			for (const Transition *transition : state->out()) {
-				const auto &liveAtDestination = liveness.getLiveRegisters(transition->to());
+		for (std::size_t state = 0; state < states.size(); ++state) {
+			std::vector<std::size_t> liveAtState;
 
-				std::vector<const Register *> killed;
-				computeKilledRegisters(*transition->instruction(), killed);
+			const auto &out = states[state]->out();
+			for (std::size_t i = 0; i < out.size(); ++i) {
+				const auto &liveAtDestination = liveness.getLiveRegisters(thread, census.getId(out[i]->to()));
+				const auto &killed = killedRegisters[state][i];
 
 				std::copy_if(
 					liveAtDestination.begin(),
 					liveAtDestination.end(),
 					std::back_inserter(liveAtState),
-					[&](const Register *reg){
+					[&](std::size_t reg){
 						return std::find(killed.begin(), killed.end(), reg) == killed.end();
 					}
 				);
 
-				computeUsedRegisters(*transition->instruction(), liveAtState);
+				const auto &used = usedRegisters[state][i];
+				liveAtState.insert(liveAtState.end(), used.begin(), used.end());
 			}
 
 			sortAndUnique(liveAtState);
 
-			auto &oldLiveAtState = liveness.getLiveRegisters(state);
+			auto &oldLiveAtState = liveness.getLiveRegisters(thread, state);
 			if (oldLiveAtState != liveAtState) {
 				changed = true;
 				oldLiveAtState = std::move(liveAtState);
@@ -158,10 +175,10 @@ void computeLiveness(const Thread &thread, Liveness &liveness) {
 
 } // anonymous namespace
 
-Liveness computeLiveness(const Program &program) {
+Liveness computeLiveness(const Program &program, const Census &census) {
 	Liveness liveness;
 	for (const Thread *thread : program.threads()) {
-		computeLiveness(*thread, liveness);
+		computeLiveness(census.getId(thread), census, liveness);
 	}
 	return liveness;
 }
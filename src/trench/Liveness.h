@@ -11,36 +11,48 @@
 
 #include <trench/config.h>
 
-#include <boost/unordered_map.hpp>
+#include <vector>
 
 namespace trench {
 
+class Census;
 class Program;
-class State;
-class Register;
 
+/**
+ * Live registers of each control state of each thread.
+ *
+ * Threads, control states and registers are identified by their ids in a Census.
+ */
 class Liveness {
-	boost::unordered_map<const State *, std::vector<const Register *>> state2liveRegisters_;
+	std::vector<std::vector<std::vector<std::size_t>>> liveRegisters_;
 public:
-	const std::vector<const Register *> &getLiveRegisters(const State *state) const {
-		auto i = state2liveRegisters_.find(state);
-		if (i != state2liveRegisters_.end()) {
-			return i->second;
+	/**
+	 * \return Sorted ids of the registers live in the given control state of the given thread.
+	 */
+	const std::vector<std::size_t> &getLiveRegisters(std::size_t thread, std::size_t state) const {
+		if (thread < liveRegisters_.size() && state < liveRegisters_[thread].size()) {
+			return liveRegisters_[thread][state];
 		} else {
-			static const std::vector<const Register *> result;
+			static const std::vector<std::size_t> result;
 			return result;
 		}
 	}
 
-	std::vector<const Register *> &getLiveRegisters(const State *state) {
-		return state2liveRegisters_[state];
+	std::vector<std::size_t> &getLiveRegisters(std::size_t thread, std::size_t state) {
+		if (thread >= liveRegisters_.size()) {
+			liveRegisters_.resize(thread + 1);
+		}
+		if (state >= liveRegisters_[thread].size()) {
+			liveRegisters_[thread].resize(state + 1);
+		}
+		return liveRegisters_[thread][state];
 	}
 
-	void setLiveRegisters(const State *state, std::vector<const Register *> liveRegisters) {
-		state2liveRegisters_[state] = std::move(liveRegisters);
+	void setLiveRegisters(std::size_t thread, std::size_t state, std::vector<std::size_t> liveRegisters) {
+		getLiveRegisters(thread, state) = std::move(liveRegisters);
 	}
 };
 
-Liveness computeLiveness(const Program &program);
+Liveness computeLiveness(const Program &program, const Census &census);
 
 } // namespace trench
@@ -0,0 +1,328 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#include "MayAddresses.h"
+
+#include <cassert>
+#include <deque>
+#include <vector>
+
+#include "Census.h"
+#include "Instruction.h"
+#include "Program.h"
+#include "State.h"
+#include "Thread.h"
+#include "Transition.h"
+
+namespace trench {
+
+namespace {
+
+typedef MayAddresses::Value Value;
+
+/**
+ * Values of the registers in a control state, indexed by register id.
+ * Empty if the control state is not reached.
+ */
+typedef std::vector<Value> Environment;
+
+Value join(Value a, Value b) {
+	if (a.kind == Value::NONE) {
+		return b;
+	} else if (b.kind == Value::NONE || a == b) {
+		return a;
+	} else {
+		return Value::unknown();
+	}
+}
+
+class ConstantPropagator {
+	const Census &census_;
+
+public:
+	explicit
+	ConstantPropagator(const Census &census): census_(census) {}
+
+	Value evaluate(const Expression &expression, const Environment &environment) const {
+		switch (expression.kind()) {
+			case Expression::CONSTANT:
+				return Value::makeConstant(expression.as<Constant>()->value());
+			case Expression::REGISTER:
+				return environment[census_.getId(expression.as<Register>())];
+			case Expression::UNARY: {
+				auto unary = expression.as<UnaryOperator>();
+				auto operand = evaluate(*unary->operand(), environment);
+				if (operand.kind != Value::CONSTANT) {
+					return Value::unknown();
+				}
+				switch (unary->kind()) {
+					case UnaryOperator::NOT:
+						return Value::makeConstant(!operand.constant);
+					default: {
+						assert(!"NEVER REACHED");
+					}
+				}
+				break;
+			}
+			case Expression::BINARY: {
+				auto binary = expression.as<BinaryOperator>();
+				auto left = evaluate(*binary->left(), environment);
+				auto right = evaluate(*binary->right(), environment);
+				if (left.kind != Value::CONSTANT || right.kind != Value::CONSTANT) {
+					return Value::unknown();
+				}
+				auto a = left.constant;
+				auto b = right.constant;
+				switch (binary->kind()) {
+					case BinaryOperator::EQ:      return Value::makeConstant(a == b);
+					case BinaryOperator::NEQ:     return Value::makeConstant(a != b);
+					case BinaryOperator::LT:      return Value::makeConstant(a < b);
+					case BinaryOperator::LEQ:     return Value::makeConstant(a <= b);
+					case BinaryOperator::GT:      return Value::makeConstant(a > b);
+					case BinaryOperator::GEQ:     return Value::makeConstant(a >= b);
+					case BinaryOperator::AND:     return Value::makeConstant(a && b);
+					case BinaryOperator::OR:      return Value::makeConstant(a || b);
+					case BinaryOperator::ADD:     return Value::makeConstant(a + b);
+					case BinaryOperator::SUB:     return Value::makeConstant(a - b);
+					case BinaryOperator::MUL:     return Value::makeConstant(a * b);
+					case BinaryOperator::BIN_AND: return Value::makeConstant(a & b);
+					default: {
+						assert(!"NEVER REACHED");
+					}
+				}
+				break;
+			}
+			case Expression::CAN_ACCESS_MEMORY:
+				return Value::unknown();
+			default: {
+				assert(!"NEVER REACHED");
+			}
+		}
+		return Value::unknown();
+	}
+
+	/**
+	 * Executes the instruction on the environment.
+	 *
+	 * \return False if the instruction can never be executed in it.
+	 */
+	bool execute(const Instruction &instruction, Environment &environment) const {
+		switch (instruction.mnemonic()) {
+			case Instruction::READ: {
+				environment[census_.getId(instruction.as<Read>()->reg().get())] = Value::unknown();
+				return true;
+			}
+			case Instruction::LOCAL: {
+				auto local = instruction.as<Local>();
+				environment[census_.getId(local->reg().get())] = evaluate(*local->value(), environment);
+				return true;
+			}
+			case Instruction::CONDITION: {
+				return assume(*instruction.as<Condition>()->expression(), environment);
+			}
+			case Instruction::ATOMIC: {
+				for (const auto &instr : instruction.as<Atomic>()->instructions()) {
+					if (!execute(*instr, environment)) {
+						return false;
+					}
+				}
+				return true;
+			}
+			case Instruction::WRITE:
+			case Instruction::MFENCE:
+			case Instruction::LOCK:
+			case Instruction::UNLOCK:
+			case Instruction::NOOP:
+				return true;
+			default: {
+				assert(!"NEVER REACHED");
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * \return True if the expression mentions the register.
+	 */
+	bool mentions(const Expression &expression, const Register *reg) const {
+		switch (expression.kind()) {
+			case Expression::REGISTER:
+				return census_.getId(expression.as<Register>()) == census_.getId(reg);
+			case Expression::UNARY:
+				return mentions(*expression.as<UnaryOperator>()->operand(), reg);
+			case Expression::BINARY: {
+				auto binary = expression.as<BinaryOperator>();
+				return mentions(*binary->left(), reg) || mentions(*binary->right(), reg);
+			}
+			default:
+				return false;
+		}
+	}
+
+private:
+	bool assume(const Expression &expression, Environment &environment) const {
+		auto value = evaluate(expression, environment);
+		if (value.kind == Value::CONSTANT) {
+			return value.constant != 0;
+		}
+
+		/* A register compared for equality with a constant becomes the constant. */
+		if (auto binary = expression.as<BinaryOperator>()) {
+			if (binary->kind() == BinaryOperator::AND) {
+				return assume(*binary->left(), environment) && assume(*binary->right(), environment);
+			} else if (binary->kind() == BinaryOperator::EQ) {
+				auto reg = binary->left()->as<Register>();
+				auto constant = binary->right()->as<Constant>();
+				if (!reg || !constant) {
+					reg = binary->right()->as<Register>();
+					constant = binary->left()->as<Constant>();
+				}
+				if (reg && constant) {
+					environment[census_.getId(reg)] = Value::makeConstant(constant->value());
+				}
+			}
+		}
+		return true;
+	}
+};
+
+} // anonymous namespace
+
+bool MayAddresses::mayHit(const boost::unordered_set<Domain> &addresses, bool anywhere, Value address) {
+	switch (address.kind) {
+		case Value::NONE:
+			return false;
+		case Value::CONSTANT:
+			return anywhere || addresses.find(address.constant) != addresses.end();
+		case Value::UNKNOWN:
+			return anywhere || !addresses.empty();
+		default: {
+			assert(!"NEVER REACHED");
+		}
+	}
+	return true;
+}
+
+bool MayAddresses::mayWrite(const Thread *thread, Value address) const {
+	auto i = threadAccesses_.find(thread);
+	return i != threadAccesses_.end() && mayHit(i->second.writes, i->second.writesAnywhere, address);
+}
+
+bool MayAddresses::mayAccess(const Thread *thread, Value address) const {
+	auto i = threadAccesses_.find(thread);
+	return i != threadAccesses_.end() && mayHit(i->second.accesses, i->second.accessesAnywhere, address);
+}
+
+MayAddresses computeMayAddresses(const Program &program) {
+	MayAddresses result;
+
+	Census census;
+	census.visit(program);
+
+	ConstantPropagator propagator(census);
+
+	for (std::size_t thread = 0; thread < census.threads().size(); ++thread) {
+		const auto &states = census.states(thread);
+		if (states.empty()) {
+			continue;
+		}
+
+		/* Least fixpoint, starting from the initial state with all the registers zero. */
+		std::vector<Environment> environments(states.size());
+		environments[0].assign(census.registers().size(), Value::makeConstant(0));
+
+		std::deque<std::size_t> queue(1, 0);
+		std::vector<bool> queued(states.size());
+		queued[0] = true;
+
+		while (!queue.empty()) {
+			auto state = queue.front();
+			queue.pop_front();
+			queued[state] = false;
+
+			for (const Transition *transition : states[state]->out()) {
+				Environment environment = environments[state];
+				if (!propagator.execute(*transition->instruction(), environment)) {
+					continue;
+				}
+
+				auto to = census.getId(transition->to());
+				auto &target = environments[to];
+
+				bool changed = false;
+				if (target.empty()) {
+					target = std::move(environment);
+					changed = true;
+				} else {
+					for (std::size_t reg = 0; reg < target.size(); ++reg) {
+						auto joined = join(target[reg], environment[reg]);
+						if (joined != target[reg]) {
+							target[reg] = joined;
+							changed = true;
+						}
+					}
+				}
+
+				if (changed && !queued[to]) {
+					queued[to] = true;
+					queue.push_back(to);
+				}
+			}
+		}
+
+		/* Addresses of the accesses in the states reached. */
+		auto &accesses = result.threadAccesses_[census.threads()[thread]];
+		for (std::size_t state = 0; state < states.size(); ++state) {
+			if (environments[state].empty()) {
+				continue;
+			}
+			for (const Transition *transition : states[state]->out()) {
+				const Expression *address;
+				const Read *read = transition->instruction()->as<Read>();
+				bool isWrite;
+				if (read) {
+					address = read->address().get();
+					isWrite = false;
+				} else if (auto write = transition->instruction()->as<Write>()) {
+					address = write->address().get();
+					isWrite = true;
+				} else {
+					continue;
+				}
+
+				/*
+				 * reduce() also accesses the address of a read after the read, which changes
+				 * the address if it depends on the register being read.
+				 */
+				auto value = propagator.evaluate(*address, environments[state]);
+				if (read && propagator.mentions(*address, read->reg().get())) {
+					value = Value::unknown();
+					result.selfAddressedReads_.insert(transition);
+				}
+				result.addresses_[transition] = value;
+
+				if (value.kind == Value::CONSTANT) {
+					accesses.accesses.insert(value.constant);
+					if (isWrite) {
+						accesses.writes.insert(value.constant);
+					}
+				} else {
+					accesses.accessesAnywhere = true;
+					if (isWrite) {
+						accesses.writesAnywhere = true;
+					}
+				}
+			}
+		}
+	}
+
+	return result;
+}
+
+} // namespace trench
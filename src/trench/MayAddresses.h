@@ -0,0 +1,102 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <trench/config.h>
+
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
+#include "Expression.h"
+
+namespace trench {
+
+class Program;
+class Thread;
+class Transition;
+
+/**
+ * Addresses the reads and writes of a program may access, ignoring memory spaces.
+ *
+ * The addresses are computed by propagating constant values of registers over the code
+ * of each thread, registers being zero initially and unknown after a read from memory.
+ * Conditions that are false for the propagated values are never satisfied.
+ * The address of a read depending on the register being read is unknown, as reduce()
+ * also accesses the address after the read, with the new value of the register.
+ */
+class MayAddresses {
+public:
+	/** Address of an access: a constant, unknown statically, or none if the access is never executed. */
+	struct Value {
+		enum Kind { NONE, CONSTANT, UNKNOWN } kind;
+		Domain constant;
+
+		static Value none() { return Value{NONE, 0}; }
+		static Value unknown() { return Value{UNKNOWN, 0}; }
+		static Value makeConstant(Domain value) { return Value{CONSTANT, value}; }
+
+		bool operator==(const Value &that) const { return kind == that.kind && constant == that.constant; }
+		bool operator!=(const Value &that) const { return !(*this == that); }
+	};
+
+private:
+	/** Addresses of reads and writes. */
+	boost::unordered_map<const Transition *, Value> addresses_;
+
+	/** Reads whose address depends on the register being read. */
+	boost::unordered_set<const Transition *> selfAddressedReads_;
+
+	/** Accesses of a thread at the addresses known statically and at unknown ones. */
+	struct Accesses {
+		boost::unordered_set<Domain> writes;
+		boost::unordered_set<Domain> accesses;
+		bool writesAnywhere;
+		bool accessesAnywhere;
+
+		Accesses(): writesAnywhere(false), accessesAnywhere(false) {}
+	};
+
+	boost::unordered_map<const Thread *, Accesses> threadAccesses_;
+
+	friend MayAddresses computeMayAddresses(const Program &program);
+
+public:
+	/**
+	 * \return Address of the read or write done by the transition.
+	 */
+	Value getAddress(const Transition *transition) const {
+		auto i = addresses_.find(transition);
+		return i != addresses_.end() ? i->second : Value::none();
+	}
+
+	/**
+	 * \return True if the transition is a read whose address depends on the register being read.
+	 */
+	bool isSelfAddressed(const Transition *transition) const {
+		return selfAddressedReads_.find(transition) != selfAddressedReads_.end();
+	}
+
+	/**
+	 * \return True if the thread may write at the given address.
+	 */
+	bool mayWrite(const Thread *thread, Value address) const;
+
+	/**
+	 * \return True if the thread may read or write at the given address.
+	 */
+	bool mayAccess(const Thread *thread, Value address) const;
+
+private:
+	static bool mayHit(const boost::unordered_set<Domain> &addresses, bool anywhere, Value address);
+};
+
+MayAddresses computeMayAddresses(const Program &program);
+
+} // namespace trench
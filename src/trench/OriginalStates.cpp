@@ -0,0 +1,217 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#include "OriginalStates.h"
+
+#include <algorithm>
+#include <cassert>
+#include <string>
+
+#include <boost/unordered_map.hpp>
+
+#include "Benchmarking.h"
+#include "Configuration.h"
+#include "Dfs.h"
+#include "Program.h"
+#include "Reduction.h"
+#include "SCSemantics.h"
+#include "State.h"
+#include "Thread.h"
+#include "Transition.h"
+
+namespace trench {
+
+namespace {
+
+const SCStateLayout::StateIndex NO_STATE = static_cast<SCStateLayout::StateIndex>(-1);
+
+std::size_t findControlState(const Census &census, std::size_t thread, const std::string &name) {
+	const auto &states = census.states(thread);
+	for (std::size_t state = 0; state < states.size(); ++state) {
+		if (states[state]->name() == name) {
+			return state;
+		}
+	}
+	return Census::NO_ID;
+}
+
+} // anonymous namespace
+
+OriginalStates::OriginalStates(const Program &program, std::size_t maxStatesCount):
+	program_(new Program(reduceToOriginalCode(program))),
+	semantics_(new SCSemantics(*program_, false)),
+	maxStatesCount_(maxStatesCount),
+	offsets_(1, 0),
+	complete_(true)
+{}
+
+OriginalStates::~OriginalStates() {}
+
+bool OriginalStates::complete() const {
+	std::call_once(explored_, [this]() { explore(); });
+	return complete_;
+}
+
+void OriginalStates::explore() const {
+	const auto &layout = semantics_->layout();
+
+	index_.resize(layout.threadsCount());
+	for (std::size_t thread = 0; thread < layout.threadsCount(); ++thread) {
+		index_[thread].resize(layout.census().states(thread).size());
+	}
+
+	/* The states are stored as they are entered. */
+	class Recorder: public EmptyDfsVisitor<SCSemantics> {
+		const OriginalStates &states_;
+
+	public:
+		explicit
+		Recorder(const OriginalStates &states): states_(states) {}
+
+		bool onStateEnter(const SCState &state) {
+			if ((states_.maxStatesCount_ > 0 && states_.size() >= states_.maxStatesCount_) || states_.size() >= static_cast<uint32_t>(-1)) {
+				states_.complete_ = false;
+				return true;
+			}
+
+			auto number = static_cast<uint32_t>(states_.size());
+			states_.bytes_.insert(states_.bytes_.end(), state.bytes().begin(), state.bytes().end());
+			states_.offsets_.push_back(states_.bytes_.size());
+
+			const auto &layout = states_.semantics_->layout();
+			for (SCStateLayout::ThreadIndex thread = 0; thread < layout.threadsCount(); ++thread) {
+				states_.index_[thread][layout.getControlStateIndex(state, thread)].push_back(number);
+			}
+			return false;
+		}
+	};
+
+	Recorder recorder(*this);
+	InPlaceDfs<SCSemantics, Recorder &>(*semantics_, recorder).visit(semantics_->initialState());
+
+	if (complete_) {
+		Statistics::instance().incOriginalStatesCount(size());
+	} else {
+		std::vector<unsigned char>().swap(bytes_);
+		offsets_.assign(1, 0);
+		index_.clear();
+	}
+}
+
+std::vector<SCState> OriginalStates::getAttackStates(const SCSemantics &semantics, const Thread *attacker, const Transition *attackWrite) const {
+	assert(complete_);
+
+	const auto &layout = semantics.layout();
+	const auto &census = layout.census();
+	const auto &originalLayout = semantics_->layout();
+	const auto &originalCensus = originalLayout.census();
+
+	assert(layout.threadsCount() == originalLayout.threadsCount());
+
+	/*
+	 * Threads are numbered in the same order, control states are matched by names, registers
+	 * are the same. Control states and registers pruned by pruneConeOfInfluence() are missing.
+	 */
+	SCStateLayout::ThreadIndex attackerIndex = SCStateLayout::NO_THREAD;
+	std::vector<std::vector<SCStateLayout::StateIndex>> controlStates(layout.threadsCount());
+	std::vector<std::vector<std::pair<std::size_t, std::size_t>>> registers(layout.threadsCount());
+
+	for (SCStateLayout::ThreadIndex thread = 0; thread < layout.threadsCount(); ++thread) {
+		assert(census.threads()[thread]->name() == originalCensus.threads()[thread]->name());
+
+		if (census.threads()[thread]->name() == attacker->name()) {
+			attackerIndex = thread;
+		}
+
+		boost::unordered_map<std::string, std::size_t> name2state;
+		for (std::size_t state = 0; state < census.states(thread).size(); ++state) {
+			name2state[census.states(thread)[state]->name()] = state;
+		}
+		for (const State *state : originalCensus.states(thread)) {
+			auto i = name2state.find(state->name());
+			controlStates[thread].push_back(i != name2state.end() ? static_cast<SCStateLayout::StateIndex>(i->second) : NO_STATE);
+		}
+
+		for (std::size_t reg : originalCensus.registers(thread)) {
+			auto id = census.getId(originalCensus.registers()[reg]);
+			if (id != Census::NO_ID && std::binary_search(census.registers(thread).begin(), census.registers(thread).end(), id)) {
+				registers[thread].push_back(std::make_pair(reg, id));
+			}
+		}
+	}
+
+	assert(attackerIndex != SCStateLayout::NO_THREAD);
+
+	/* The transition of the attacker making the attack's write go into the buffer. */
+	const Instruction *attackInstruction = NULL;
+	for (const Transition *transition : census.threads()[attackerIndex]->transitions()) {
+		if (transition->from()->name() == "orig_" + attackWrite->from()->name() &&
+		    transition->to()->name() == "att_" + attackWrite->to()->name()) {
+			attackInstruction = transition->instruction().get();
+		}
+	}
+
+	std::vector<SCState> result;
+
+	/* The cone of influence removes the transition when the attack can never be completed. */
+	if (!attackInstruction) {
+		return result;
+	}
+
+	auto originalState = findControlState(originalCensus, attackerIndex, "orig_" + attackWrite->from()->name());
+	if (originalState == Census::NO_ID) {
+		return result;
+	}
+
+	SCTransition transition;
+	for (uint32_t number : index_[attackerIndex][originalState]) {
+		SCState original(std::vector<unsigned char>(bytes_.begin() + offsets_[number], bytes_.begin() + offsets_[number + 1]), 0);
+		SCState state(layout.size());
+
+		/*
+		 * A thread is in a pruned control state only after it has passed a kept one from which
+		 * it can influence nothing. The state with the thread stopped there is explored too.
+		 */
+		bool pruned = false;
+		for (SCStateLayout::ThreadIndex thread = 0; thread < layout.threadsCount(); ++thread) {
+			pruned = pruned || controlStates[thread][originalLayout.getControlStateIndex(original, thread)] == NO_STATE;
+		}
+		if (pruned) {
+			continue;
+		}
+
+		for (SCStateLayout::ThreadIndex thread = 0; thread < layout.threadsCount(); ++thread) {
+			layout.setControlStateIndex(state, thread, controlStates[thread][originalLayout.getControlStateIndex(original, thread)]);
+			for (const auto &reg : registers[thread]) {
+				layout.setRegisterValue(state, thread, reg.second, originalLayout.getRegisterValue(original, thread, reg.first));
+			}
+		}
+		layout.setMemoryLockOwner(state, originalLayout.getMemoryLockOwner(original));
+		originalLayout.forEachMemoryCell(original, [&](Space space, Address address, Domain value) {
+			layout.setMemoryValue(state, space, address, value);
+		});
+
+		if (Configuration::instance().livenessOptimization()) {
+			for (SCStateLayout::ThreadIndex thread = 0; thread < layout.threadsCount(); ++thread) {
+				layout.resetDeadRegisters(state, thread, layout.getControlStateIndex(state, thread));
+			}
+		}
+
+		auto cursor = semantics.getTransitionsFrom(state, attackerIndex);
+		while (semantics.getNextTransition(state, cursor, transition)) {
+			if (transition.instruction() == attackInstruction) {
+				result.push_back(transition.destination());
+			}
+		}
+	}
+
+	return result;
+}
+
+} // namespace trench
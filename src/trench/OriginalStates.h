@@ -0,0 +1,93 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <trench/config.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace trench {
+
+class Program;
+class SCSemantics;
+class SCState;
+class Thread;
+class Transition;
+
+/**
+ * States of a program reachable under SC before any thread becomes an attacker.
+ *
+ * Until the first write of an attacker goes into the buffer, all the threads of a program
+ * instrumented by reduce() execute their original code, whatever the attack is. These states
+ * are explored once, without reductions, when first needed, and the searches for attacks
+ * start from them. The exploration is thread-safe.
+ *
+ * The states are stored one after another in a single byte array and indexed
+ * by the thread and its control state.
+ */
+class OriginalStates {
+	/** Original code of the program, as reduceToOriginalCode() makes it. */
+	std::unique_ptr<Program> program_;
+	std::unique_ptr<SCSemantics> semantics_;
+
+	std::size_t maxStatesCount_;
+	mutable std::once_flag explored_;
+
+	mutable std::vector<unsigned char> bytes_;
+
+	/** Offsets of the states in bytes_, followed by the size of bytes_. */
+	mutable std::vector<std::size_t> offsets_;
+
+	/** Numbers of the states, indexed by thread id and control state id. */
+	mutable std::vector<std::vector<std::vector<uint32_t>>> index_;
+
+	mutable bool complete_;
+
+public:
+	/**
+	 * \param program        Program.
+	 * \param maxStatesCount Number of states after which the exploration gives up, zero if unlimited.
+	 */
+	OriginalStates(const Program &program, std::size_t maxStatesCount);
+	~OriginalStates();
+
+	/**
+	 * Explores the states, unless done before.
+	 *
+	 * \return True if all the states have been explored.
+	 */
+	bool complete() const;
+
+	/**
+	 * \return Number of the states explored.
+	 */
+	std::size_t size() const { return offsets_.size() - 1; }
+
+	/**
+	 * Computes the states in which the attacker has just made the attack's write.
+	 * Must be called only if complete() has returned true.
+	 * The interesting state is reachable from one of them if and only if it is reachable
+	 * from the initial state.
+	 *
+	 * \param semantics   Semantics of the program made by reduce() for the attack.
+	 * \param attacker    Attacker thread of the original program.
+	 * \param attackWrite Attacker's write of the original program.
+	 */
+	std::vector<SCState> getAttackStates(const SCSemantics &semantics, const Thread *attacker, const Transition *attackWrite) const;
+
+private:
+	void explore() const;
+};
+
+} // namespace trench
@@ -8,7 +8,13 @@
  */
 
 #include "Program.h"
+
+#include <utility>
+#include <vector>
+
+#include "State.h"
 #include "Thread.h"
+#include "Transition.h"
 
 namespace trench {
 
@@ -30,4 +36,42 @@ Thread *Program::makeThread(const std::string &name) {
 	return result.get();
 }
 
+bool isAcyclic(const Program &program) {
+	enum Color { WHITE, GREY, BLACK };
+
+	for (Thread *thread : program.threads()) {
+		boost::unordered_map<const State *, Color> colors;
+		std::vector<std::pair<const State *, std::size_t>> stack;
+
+		for (const State *root : thread->states()) {
+			if (colors[root] != WHITE) {
+				continue;
+			}
+			colors[root] = GREY;
+			stack.push_back(std::make_pair(root, 0));
+
+			while (!stack.empty()) {
+				auto state = stack.back().first;
+				auto index = stack.back().second++;
+
+				if (index < state->out().size()) {
+					const State *to = state->out()[index]->to();
+					auto &color = colors[to];
+					if (color == GREY) {
+						return false;
+					} else if (color == WHITE) {
+						color = GREY;
+						stack.push_back(std::make_pair(to, 0));
+					}
+				} else {
+					colors[state] = BLACK;
+					stack.pop_back();
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
 } // namespace trench
@@ -48,4 +48,9 @@ public:
 	Space interestingSpace() const { return interestingSpace_; }
 };
 
+/**
+ * \return True if the control flow graphs of all the threads of the program are acyclic.
+ */
+bool isAcyclic(const Program &program);
+
 } // namespace trench
@@ -9,7 +9,22 @@
 
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Benchmarking.h"
+#include "BestFirst.h"
+#include "Bfs.h"
+#include "ConcurrentSet.h"
 #include "Dfs.h"
+#include "Dpor.h"
+#include "ExternalBfs.h"
+#include "ThreadPool.h"
 
 namespace trench {
 
@@ -31,4 +46,274 @@ bool isFinalStateReachable(const Automaton &automaton) {
 	return dfs<Automaton, const ReachabilityVisitor<Automaton> &>(automaton, ReachabilityVisitor<Automaton>(automaton));
 }
 
+/**
+ * Checks whether a final state is reachable from one of the given states, keeping the visited states in the given set.
+ */
+template<class Automaton, class StateSet>
+bool isFinalStateReachable(const Automaton &automaton, const std::vector<typename Automaton::State> &roots, StateSet visited) {
+	ReachabilityVisitor<Automaton> visitor(automaton);
+	Dfs<Automaton, const ReachabilityVisitor<Automaton> &, StateSet> dfs(automaton, visitor, std::move(visited));
+	for (const auto &root : roots) {
+		if (dfs.visit(root)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Checks whether a final state is reachable, keeping the visited states in the given set.
+ */
+template<class Automaton, class StateSet>
+bool isFinalStateReachable(const Automaton &automaton, StateSet visited) {
+	return isFinalStateReachable(automaton, {automaton.initialState()}, std::move(visited));
+}
+
+/**
+ * Checks whether a final state is reachable from one of the given states using the depth-first
+ * search changing a single state in place.
+ */
+template<class Automaton, class StateSet>
+bool isFinalStateReachableInPlace(const Automaton &automaton, const std::vector<typename Automaton::State> &roots, StateSet visited) {
+	ReachabilityVisitor<Automaton> visitor(automaton);
+	InPlaceDfs<Automaton, const ReachabilityVisitor<Automaton> &, StateSet> dfs(automaton, visitor, std::move(visited));
+	for (const auto &root : roots) {
+		if (dfs.visit(root)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Checks whether a final state is reachable using the depth-first search changing a single state in place.
+ */
+template<class Automaton, class StateSet = boost::unordered_set<typename Automaton::State>>
+bool isFinalStateReachableInPlace(const Automaton &automaton, StateSet visited = StateSet()) {
+	return isFinalStateReachableInPlace(automaton, {automaton.initialState()}, std::move(visited));
+}
+
+/**
+ * Visitor stopping the search in a final state or when it has entered too many states.
+ */
+template<class Automaton>
+class BoundedReachabilityVisitor: public EmptyDfsVisitor<Automaton> {
+	const Automaton &automaton_;
+	std::size_t maxStatesCount_;
+	std::size_t statesCount_;
+	bool found_;
+
+public:
+	BoundedReachabilityVisitor(const Automaton &automaton, std::size_t maxStatesCount):
+		automaton_(automaton), maxStatesCount_(maxStatesCount), statesCount_(0), found_(false)
+	{}
+
+	bool found() const { return found_; }
+
+	bool onStateEnter(const typename Automaton::State &state) {
+		found_ = automaton_.isFinal(state);
+		return found_ || ++statesCount_ > maxStatesCount_;
+	}
+};
+
+/**
+ * Checks whether a final state is reachable from one of the given states using the depth-first
+ * search changing a single state in place, giving up after entering the given number of states.
+ *
+ * \param[in]  automaton      Automaton.
+ * \param[in]  roots          States to start the search from.
+ * \param[in]  maxStatesCount Number of states after which the search gives up.
+ * \param[out] complete       Whether the search has not given up.
+ */
+template<class Automaton>
+bool isFinalStateReachableInPlace(const Automaton &automaton, const std::vector<typename Automaton::State> &roots, std::size_t maxStatesCount, bool &complete) {
+	BoundedReachabilityVisitor<Automaton> visitor(automaton, maxStatesCount);
+	InPlaceDfs<Automaton, BoundedReachabilityVisitor<Automaton> &> dfs(automaton, visitor);
+	for (const auto &root : roots) {
+		if (dfs.visit(root)) {
+			complete = visitor.found();
+			return visitor.found();
+		}
+	}
+	complete = true;
+	return false;
+}
+
+/**
+ * Checks whether a final state is reachable using the depth-first search with sleep sets.
+ */
+template<class Automaton>
+bool isFinalStateReachableWithSleepSets(const Automaton &automaton) {
+	ReachabilityVisitor<Automaton> visitor(automaton);
+	return SleepSetDfs<Automaton, const ReachabilityVisitor<Automaton> &>(automaton, visitor)
+		.visit(automaton.initialState());
+}
+
+/**
+ * Checks whether a final state is reachable using the stateless search with dynamic partial order reduction.
+ * The state space of the automaton must be acyclic.
+ *
+ * \param[in]  automaton      Automaton.
+ * \param[in]  maxStatesCount Number of states after which the search gives up, zero if unlimited.
+ * \param[out] complete       Whether the search has not given up.
+ */
+template<class Automaton>
+bool isFinalStateReachableStatelessly(const Automaton &automaton, std::size_t maxStatesCount, bool &complete) {
+	StatelessDpor<Automaton> dpor(automaton, maxStatesCount);
+	auto result = dpor.run();
+	complete = dpor.isComplete();
+	return result;
+}
+
+/**
+ * Checks whether a final state is reachable using the breadth-first search with the given number of threads.
+ */
+template<class Automaton>
+bool isFinalStateReachableBreadthFirst(const Automaton &automaton, std::size_t nworkers) {
+	return Bfs<Automaton>(automaton, nworkers).run();
+}
+
+/**
+ * Checks whether a final state is reachable using the best-first search guided by
+ * the automaton's estimate of the distance to a final state.
+ *
+ * \param automaton Automaton.
+ * \param greedy    Whether the search orders the states by the estimate alone,
+ *                  or by the length of the path to them plus the estimate (A*).
+ */
+template<class Automaton>
+bool isFinalStateReachableBestFirst(const Automaton &automaton, bool greedy) {
+	return BestFirstSearch<Automaton>(automaton, greedy).run();
+}
+
+/**
+ * Checks whether a final state is reachable using the breadth-first search
+ * writing the visited states out to disk when they take more than the given
+ * number of bytes in memory.
+ */
+template<class Automaton>
+bool isFinalStateReachableInExternalMemory(const Automaton &automaton, std::size_t memoryLimit) {
+	return ExternalBfs<Automaton>(automaton, memoryLimit).run();
+}
+
+/**
+ * Reachability check exploring the state space with several threads.
+ *
+ * Each worker owns a deque of states to be expanded. It takes states from
+ * the back of its own deque and, when it runs dry, steals from the front
+ * of the others' deques. Visited states are kept in a set shared by all
+ * the workers. As soon as one worker finds a final state, all of them stop.
+ */
+template<class Automaton, class StateSet = boost::unordered_set<typename Automaton::State>>
+class ParallelReachability {
+	typedef typename Automaton::State State;
+
+	struct Worker {
+		std::mutex mutex;
+		std::deque<State> states;
+	};
+
+	const Automaton &automaton_;
+	ConcurrentSet<State, StateSet> visited_;
+	std::vector<std::unique_ptr<Worker>> workers_;
+
+	/** Number of states pushed into the deques, but not expanded yet. */
+	std::atomic<std::size_t> pending_;
+	std::atomic<bool> found_;
+
+public:
+	ParallelReachability(const Automaton &automaton, std::size_t nworkers):
+		automaton_(automaton), pending_(0), found_(false)
+	{
+		for (std::size_t i = 0; i < nworkers; ++i) {
+			workers_.push_back(std::make_unique<Worker>());
+		}
+	}
+
+	~ParallelReachability() {
+		Statistics::instance().incVisitedStatesCount(visited_.size());
+	}
+
+	bool run() {
+		auto initialState = automaton_.initialState();
+		visited_.insert(initialState);
+		if (automaton_.isFinal(initialState)) {
+			return true;
+		}
+		push(0, std::move(initialState));
+
+		{
+			ThreadPool<> pool(workers_.size());
+			for (std::size_t i = 0; i < workers_.size(); ++i) {
+				pool.schedule([this, i] { work(i); });
+			}
+		}
+
+		return found_;
+	}
+
+private:
+	void work(std::size_t index) {
+		State state;
+		typename Automaton::Transition transition;
+		while (!found_) {
+			if (pop(index, state) || steal(index, state)) {
+				auto cursor = automaton_.getTransitionsFrom(state);
+				while (automaton_.getNextTransition(state, cursor, transition)) {
+					const auto &destination = automaton_.getDestinationState(transition);
+					if (visited_.insert(destination)) {
+						if (automaton_.isFinal(destination)) {
+							found_ = true;
+							break;
+						}
+						push(index, destination);
+					}
+				}
+				--pending_;
+			} else if (pending_ == 0) {
+				break;
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void push(std::size_t index, State state) {
+		++pending_;
+
+		auto &worker = *workers_[index];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		worker.states.push_back(std::move(state));
+	}
+
+	bool pop(std::size_t index, State &state) {
+		auto &worker = *workers_[index];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		if (worker.states.empty()) {
+			return false;
+		}
+		state = std::move(worker.states.back());
+		worker.states.pop_back();
+		return true;
+	}
+
+	bool steal(std::size_t index, State &state) {
+		for (std::size_t i = 1; i < workers_.size(); ++i) {
+			auto &victim = *workers_[(index + i) % workers_.size()];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			if (!victim.states.empty()) {
+				state = std::move(victim.states.front());
+				victim.states.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+};
+
+template<class Automaton, class StateSet = boost::unordered_set<typename Automaton::State>>
+bool isFinalStateReachableInParallel(const Automaton &automaton, std::size_t nworkers) {
+	return ParallelReachability<Automaton, StateSet>(automaton, nworkers).run();
+}
+
 } // namespace trench
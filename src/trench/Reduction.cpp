@@ -12,6 +12,9 @@
 #include <algorithm>
 #include <cassert>
 
+#include <boost/unordered_map.hpp>
+
+#include "Census.h"
 #include "Expression.h"
 #include "ExpressionsCache.h"
 #include "Instruction.h"
@@ -21,7 +24,26 @@
 
 namespace trench {
 
-Program reduce(const Program &program, bool searchForTdrOnly, Thread *attacker, Transition *attackWrite, Transition *attackRead, const boost::unordered_set<State *> &fenced) {
+namespace {
+
+void makeOriginalTransition(Thread *thread, State *from, State *to, const Transition *transition, const std::shared_ptr<Condition> &checkCanAccessMemory) {
+	if (transition->instruction()->is<Read>() || transition->instruction()->is<Write>()) {
+		thread->makeTransition(
+			from,
+			to,
+			std::make_shared<Atomic>(
+				checkCanAccessMemory,
+				transition->instruction()
+			)
+		);
+	} else {
+		thread->makeTransition(from, to, transition->instruction());
+	}
+}
+
+} // anonymous namespace
+
+Program reduce(const Program &program, bool searchForTdrOnly, Thread *attacker, Transition *attackWrite, Transition *attackRead, const boost::unordered_set<State *> &fenced, bool recordAttack) {
 	assert(attackWrite == NULL || attackWrite->instruction()->is<Write>());
 	assert(attackRead == NULL || attackRead->instruction()->is<Read>());
 
@@ -48,6 +70,8 @@ Program reduce(const Program &program, bool searchForTdrOnly, Thread *attacker,
 	auto attackAddress = cache.makeRegister("_attack_addr");
 	auto nattackersVar = cache.makeConstant(0);
 	auto successVar    = cache.makeConstant(1);
+	auto attackWriteVar = cache.makeConstant(ATTACK_WRITE_ADDRESS);
+	auto attackReadVar  = cache.makeConstant(ATTACK_READ_ADDRESS);
 
 	result.setInterestingAddress(successVar->value(), SERVICE_SPACE);
 
@@ -68,11 +92,46 @@ Program reduce(const Program &program, bool searchForTdrOnly, Thread *attacker,
 
 	auto check_can_access_memory = std::make_shared<Condition>(std::make_shared<CanAccessMemory>());
 
+	Census census;
+	census.visit(program);
+
+	/* Numbers recorded for the attack's write and read. */
+	boost::unordered_map<const Transition *, std::shared_ptr<Constant>> transition2number;
+	if (recordAttack) {
+		for (Thread *thread : program.threads()) {
+			for (Transition *transition : thread->transitions()) {
+				auto number = transition2number.size() + 1;
+				transition2number[transition] = cache.makeConstant(number);
+			}
+		}
+	}
+
 	for (Thread *thread : program.threads()) {
 		Thread *resultThread = result.makeThread(thread->name());
 
+		/* Copies of the thread's states, indexed by state id. */
+		const auto &states = census.states(census.getId(thread));
+		std::vector<State *> originalStates(states.size());
+		std::vector<State *> attackerStates(states.size());
+		std::vector<State *> helperStates(states.size());
+
+		auto makeCopy = [&](std::vector<State *> &copies, const char *prefix, const State *state) {
+			auto &copy = copies[census.getId(state)];
+			if (!copy) {
+				copy = resultThread->makeState(prefix + state->name());
+			}
+			return copy;
+		};
+
+		std::vector<bool> isFenced(states.size());
+		if (!fenced.empty()) {
+			for (std::size_t i = 0; i < states.size(); ++i) {
+				isFenced[i] = fenced.find(const_cast<State *>(states[i])) != fenced.end();
+			}
+		}
+
 		if (thread->initialState()) {
-			resultThread->setInitialState(resultThread->makeState("orig_" + thread->initialState()->name()));
+			resultThread->setInitialState(makeCopy(originalStates, "orig_", thread->initialState()));
 		}
 
 		auto prefinalState = resultThread->makeState("_prefinal");
@@ -81,25 +140,14 @@ Program reduce(const Program &program, bool searchForTdrOnly, Thread *attacker,
 			/*
 			 * Original code.
 			 */
-			State *originalFrom = resultThread->makeState("orig_" + transition->from()->name());
-			State *originalTo = resultThread->makeState("orig_" + transition->to()->name());
-
-			if (transition->instruction()->is<Read>() || transition->instruction()->is<Write>()) {
-				resultThread->makeTransition(
-					originalFrom,
-					originalTo,
-					std::make_shared<Atomic>(
-						check_can_access_memory,
-						transition->instruction()
-					)
-				);
-			} else {
-				resultThread->makeTransition(originalFrom, originalTo, transition->instruction());
-			}
+			State *originalFrom = makeCopy(originalStates, "orig_", transition->from());
+			State *originalTo = makeCopy(originalStates, "orig_", transition->to());
+
+			makeOriginalTransition(resultThread, originalFrom, originalTo, transition, check_can_access_memory);
 
 			if (thread == attacker || attacker == NULL) {
-				State *attackerFrom = resultThread->makeState("att_" + transition->from()->name());
-				State *attackerTo   = resultThread->makeState("att_" + transition->to()->name());
+				State *attackerFrom = makeCopy(attackerStates, "att_", transition->from());
+				State *attackerTo   = makeCopy(attackerStates, "att_", transition->to());
 
 				/*
 				 * Becoming an attacker.
@@ -107,18 +155,21 @@ Program reduce(const Program &program, bool searchForTdrOnly, Thread *attacker,
 				if (Write *write = transition->instruction()->as<Write>()) {
 					if (transition == attackWrite || attackWrite == NULL) {
 						/* First write going into the buffer. */
-						resultThread->makeTransition(
-							originalFrom,
-							attackerTo,
-							std::make_shared<Atomic>(
-								std::make_shared<Read> (nattackers,       nattackersVar,    SERVICE_SPACE),
-								std::make_shared<Condition>(std::make_shared<BinaryOperator>(BinaryOperator::EQ, nattackers, zero)),
-								std::make_shared<Write>(one,              nattackersVar,    SERVICE_SPACE),
-								std::make_shared<Local>(attackAddress,    write->address()),
-								std::make_shared<Write>(write->value(),   attackAddress,    BUFFER_SPACE),
-								std::make_shared<Write>(one,              attackAddress,    IS_BUFFERED_SPACE)
-							)
+						std::shared_ptr<Instruction> instruction = std::make_shared<Atomic>(
+							std::make_shared<Read> (nattackers,       nattackersVar,    SERVICE_SPACE),
+							std::make_shared<Condition>(std::make_shared<BinaryOperator>(BinaryOperator::EQ, nattackers, zero)),
+							std::make_shared<Write>(one,              nattackersVar,    SERVICE_SPACE),
+							std::make_shared<Local>(attackAddress,    write->address()),
+							std::make_shared<Write>(write->value(),   attackAddress,    BUFFER_SPACE),
+							std::make_shared<Write>(one,              attackAddress,    IS_BUFFERED_SPACE)
 						);
+						if (recordAttack) {
+							instruction = std::make_shared<Atomic>(
+								instruction,
+								std::make_shared<Write>(transition2number[transition], attackWriteVar, SERVICE_SPACE)
+							);
+						}
+						resultThread->makeTransition(originalFrom, attackerTo, instruction);
 					}
 				}
 
@@ -126,7 +177,7 @@ Program reduce(const Program &program, bool searchForTdrOnly, Thread *attacker,
 				 * Attacker's execution.
 				 */
 
-				if (fenced.find(transition->from()) != fenced.end()) {
+				if (isFenced[census.getId(transition->from())]) {
 					/* No transition from an extra fenced state. */
 				} else if (Write *write = transition->instruction()->as<Write>()) {
 					if (!searchForTdrOnly) {
@@ -166,17 +217,20 @@ Program reduce(const Program &program, bool searchForTdrOnly, Thread *attacker,
 
 					/* ...or from memory and update HB. This is the final aim of attacker's existence. */
 					if (transition == attackRead || attackRead == NULL) {
-						resultThread->makeTransition(
-							attackerFrom,
-							prefinalState,
-							std::make_shared<Atomic>(
-								check_can_access_memory,
-								std::make_shared<Read> (is_buffered, read->address(), IS_BUFFERED_SPACE),
-								check_is_not_buffered,
-								transition->instruction(),
-								std::make_shared<Write>(hb_read,     read->address(), HB_SPACE)
-							)
+						std::shared_ptr<Instruction> instruction = std::make_shared<Atomic>(
+							check_can_access_memory,
+							std::make_shared<Read> (is_buffered, read->address(), IS_BUFFERED_SPACE),
+							check_is_not_buffered,
+							transition->instruction(),
+							std::make_shared<Write>(hb_read,     read->address(), HB_SPACE)
 						);
+						if (recordAttack) {
+							instruction = std::make_shared<Atomic>(
+								instruction,
+								std::make_shared<Write>(transition2number[transition], attackReadVar, SERVICE_SPACE)
+							);
+						}
+						resultThread->makeTransition(attackerFrom, prefinalState, instruction);
 					}
 				} else if (transition->instruction()->as<Mfence>()) {
 					/* No transition: attacker can't execute fences. */
@@ -199,8 +253,8 @@ Program reduce(const Program &program, bool searchForTdrOnly, Thread *attacker,
 			}
 
 			if (thread != attacker) {
-				State *helperFrom = resultThread->makeState("hlp_" + transition->from()->name());
-				State *helperTo   = resultThread->makeState("hlp_" + transition->to()->name());
+				State *helperFrom = makeCopy(helperStates, "hlp_", transition->from());
+				State *helperTo   = makeCopy(helperStates, "hlp_", transition->to());
 
 				if (searchForTdrOnly) {
 					if (Write *write = transition->instruction()->as<Write>()) {
@@ -308,4 +362,30 @@ Program reduce(const Program &program, bool searchForTdrOnly, Thread *attacker,
 	return result;
 }
 
+Program reduceToOriginalCode(const Program &program) {
+	auto check_can_access_memory = std::make_shared<Condition>(std::make_shared<CanAccessMemory>());
+
+	Program result;
+
+	for (Thread *thread : program.threads()) {
+		Thread *resultThread = result.makeThread(thread->name());
+
+		if (thread->initialState()) {
+			resultThread->setInitialState(resultThread->makeState("orig_" + thread->initialState()->name()));
+		}
+
+		for (Transition *transition : thread->transitions()) {
+			makeOriginalTransition(
+				resultThread,
+				resultThread->makeState("orig_" + transition->from()->name()),
+				resultThread->makeState("orig_" + transition->to()->name()),
+				transition,
+				check_can_access_memory
+			);
+		}
+	}
+
+	return result;
+}
+
 } // namespace trench
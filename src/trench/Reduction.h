@@ -20,8 +20,33 @@ class State;
 class Thread;
 class Transition;
 
+/**
+ * Addresses of the cells in the interesting space of the program made by reduce(), to which
+ * the instrumentation recording the attack writes the numbers of the attack's write and read.
+ * The transitions of the original program are numbered from one, thread by thread,
+ * in the order of Program::threads() and Thread::transitions().
+ */
+enum {
+	ATTACK_WRITE_ADDRESS = 2,
+	ATTACK_READ_ADDRESS = 3
+};
+
+/**
+ * Instruments the program for checking whether the given attack is feasible: the interesting
+ * state of the result is reachable under SC if and only if it is. If the attacker, its write
+ * or its read is not given, any one fits, and if recordAttack is true, the attack's write
+ * and read are recorded when made.
+ */
 Program reduce(const Program &program, bool searchForTdrOnly,
 	Thread *attacker = NULL, Transition *attackWrite = NULL, Transition *attackRead = NULL,
-	const boost::unordered_set<State *> &fenced = boost::unordered_set<State *>());
+	const boost::unordered_set<State *> &fenced = boost::unordered_set<State *>(),
+	bool recordAttack = false);
+
+/**
+ * \return Program consisting of the original code of the program as reduce() instruments it,
+ *         i.e. of what the threads execute before any of them becomes an attacker.
+ *         The control states are named as in the result of reduce().
+ */
+Program reduceToOriginalCode(const Program &program);
 
 } // namespace trench
@@ -9,69 +9,160 @@
 
 #include "RobustnessChecking.h"
 
+#include <cassert>
+#include <memory>
+
+#include "BackwardReachability.h"
 #include "Benchmarking.h"
+#include "ConeOfInfluence.h"
+#include "Configuration.h"
+#include "Dfs.h"
+#include "FenceFreeReachability.h"
+#include "MayAddresses.h"
 #include "Program.h"
 #include "Reduction.h"
 #include "SCReachability.h"
+#include "SCSemantics.h"
 #include "State.h"
+#include "Thread.h"
 #include "Transition.h"
 
 namespace trench {
 
 namespace {
 
-bool isReachable(State *state, State *target, boost::unordered_set<State *> &visited) {
-	if (state == target) {
+/**
+ * \return False if the addresses accessed make the happens-before cycle of the attack
+ *         impossible to close, true otherwise.
+ */
+bool mayCloseCycle(const Program &program, const MayAddresses &addresses, bool searchForTdrOnly, Thread *attacker, Transition *attackWrite, Transition *attackRead) {
+	auto writeAddress = addresses.getAddress(attackWrite);
+	auto readAddress = addresses.getAddress(attackRead);
+
+	if (writeAddress.kind == MayAddresses::Value::NONE || readAddress.kind == MayAddresses::Value::NONE) {
+		return false;
+	}
+
+	/*
+	 * reduce() marks the address of the attack's read after the read, so a read
+	 * depending on its own register may itself mark the address of the attack's write.
+	 */
+	if (addresses.isSelfAddressed(attackRead)) {
 		return true;
 	}
 
-	if (visited.find(state) != visited.end()) {
+	/* The attack's read must not be served from the buffer holding the attack's write. */
+	if (writeAddress.kind == MayAddresses::Value::CONSTANT && writeAddress == readAddress) {
 		return false;
 	}
 
-	visited.insert(state);
-
-	for (Transition *transition : state->out()) {
-		switch (transition->instruction()->mnemonic()) {
-			case Instruction::READ:
-			case Instruction::WRITE:
-			case Instruction::LOCAL:
-			case Instruction::CONDITION:
-			case Instruction::NOOP:
-				if (isReachable(transition->to(), target, visited)) {
-					return true;
-				}
-				break;
-			case Instruction::MFENCE:
-			case Instruction::LOCK:
-			case Instruction::UNLOCK:
-				break;
-			default: {
-				assert(!"NEVER REACHED");
-			}
+	/*
+	 * The first helper must write at the address of the attack's read.
+	 * Unless looking for a triangular data race, some helper must then access
+	 * the address of the attack's write.
+	 */
+	bool readOverwritten = false;
+	bool writeAccessed = searchForTdrOnly;
+	for (Thread *thread : program.threads()) {
+		if (thread != attacker) {
+			readOverwritten = readOverwritten || addresses.mayWrite(thread, readAddress);
+			writeAccessed = writeAccessed || addresses.mayAccess(thread, writeAddress);
 		}
 	}
 
-	return false;
+	return readOverwritten && writeAccessed;
 }
 
 } // anonymous namespace
 
-bool isAttackFeasible(const Program &program, bool searchForTdrOnly, Thread *attacker, Transition *attackWrite, Transition *attackRead, const boost::unordered_set<State *> &fenced) {
+bool isAttackFeasible(const Program &program, bool searchForTdrOnly, Thread *attacker, Transition *attackWrite, Transition *attackRead, const boost::unordered_set<State *> &fenced, const AttackCheckOptions &options) {
 
 	Statistics::instance().incPotentialAttacksCount();
 
+	auto reachability = options.reachability;
+	auto addresses = options.addresses;
+	auto originalStates = options.originalStates;
+
 	if (attackWrite && attackRead) {
-		boost::unordered_set<State *> visited(fenced);
-		if (!isReachable(attackWrite->to(), attackRead->from(), visited)) {
+		std::unique_ptr<FenceFreeReachability> ownReachability;
+		if (!reachability) {
+			ownReachability.reset(new FenceFreeReachability(attacker));
+			reachability = ownReachability.get();
+		}
+		assert(reachability->thread() == attacker);
+
+		bool reachable = fenced.empty() ?
+			reachability->isReachable(attackWrite->to(), attackRead->from()) :
+			reachability->isReachable(attackWrite->to(), attackRead->from(), reachability->makeStateSet(fenced));
+		if (!reachable) {
+			Statistics::instance().incInfeasibleAttacksCount1();
+			return false;
+		}
+
+		std::unique_ptr<MayAddresses> ownAddresses;
+		if (!addresses) {
+			ownAddresses.reset(new MayAddresses(computeMayAddresses(program)));
+			addresses = ownAddresses.get();
+		}
+
+		if (!mayCloseCycle(program, *addresses, searchForTdrOnly, attacker, attackWrite, attackRead)) {
+			Statistics::instance().incAddressInfeasibleAttacksCount();
 			Statistics::instance().incInfeasibleAttacksCount1();
 			return false;
 		}
 	}
 
+	if (options.feasibleAttacks) {
+		assert(attackWrite && attackRead && fenced.empty());
+
+		bool feasible = options.feasibleAttacks->find(std::make_pair(attackWrite, attackRead)) != options.feasibleAttacks->end();
+		if (feasible) {
+			Statistics::instance().incFeasibleAttacksCount();
+		} else {
+			Statistics::instance().incInfeasibleAttacksCount2();
+		}
+		return feasible;
+	}
+
 	auto augmentedProgram = reduce(program, searchForTdrOnly, attacker, attackWrite, attackRead, fenced);
+	if (Configuration::instance().coneOfInfluence()) {
+		augmentedProgram = pruneConeOfInfluence(augmentedProgram);
+	}
 
-	bool feasible = isInterestingStateSCReachable(augmentedProgram);
+	if (Configuration::instance().backwardSearch() &&
+	    isInterestingStateSCUnreachable(augmentedProgram, Configuration::instance().backwardSearchLimit())) {
+		Statistics::instance().incBackwardInfeasibleAttacksCount();
+		Statistics::instance().incInfeasibleAttacksCount2();
+		return false;
+	}
+
+	bool feasible = false;
+
+	if (options.bitstateMemory > 0) {
+		feasible = isInterestingStateSCReachable(augmentedProgram, options.bitstateMemory);
+		if (feasible) {
+			Statistics::instance().incBitstateFeasibleAttacksCount();
+		}
+	}
+
+	if (!feasible && (options.bitstateMemory == 0 || options.exact)) {
+		if (!attackWrite) {
+			originalStates = NULL;
+		}
+
+		/* The attacks of computeFences() are already checked in parallel, one per thread. */
+		std::size_t nworkers = attacker ? 1 : Configuration::instance().workersCount();
+
+		/* The interesting cell of the reduced program is only ever set to one. */
+		if (Configuration::instance().statelessSearch() && Configuration::instance().searchOrder() == Configuration::DEPTH_FIRST &&
+		    Configuration::instance().backend() == Configuration::EXPLICIT && isAcyclic(augmentedProgram)) {
+			feasible = isInterestingStateSCReachableStatelessly(augmentedProgram, originalStates, attacker, attackWrite, nworkers);
+		} else if (originalStates) {
+			feasible = isInterestingStateSCReachable(augmentedProgram, *originalStates, attacker, attackWrite);
+		} else {
+			feasible = isInterestingStateSCReachable(augmentedProgram, 0, nworkers);
+		}
+	}
 
 	if (feasible) {
 		Statistics::instance().incFeasibleAttacksCount();
@@ -82,4 +173,46 @@ bool isAttackFeasible(const Program &program, bool searchForTdrOnly, Thread *att
 	return feasible;
 }
 
+AttackSet findFeasibleAttacks(const Program &program, bool searchForTdrOnly) {
+	std::vector<Transition *> transitions;
+	for (Thread *thread : program.threads()) {
+		transitions.insert(transitions.end(), thread->transitions().begin(), thread->transitions().end());
+	}
+
+	auto augmentedProgram = reduce(program, searchForTdrOnly, NULL, NULL, NULL, boost::unordered_set<State *>(), true);
+	SCSemantics semantics(augmentedProgram);
+
+	/* Collects the numbers of the writes and reads of the attacks completed in the visited states. */
+	class AttackCollector: public EmptyDfsVisitor<SCSemantics> {
+		const SCSemantics &semantics_;
+		Space space_;
+		boost::unordered_set<std::pair<Domain, Domain>> attacks_;
+
+	public:
+		AttackCollector(const SCSemantics &semantics, Space space): semantics_(semantics), space_(space) {}
+
+		const boost::unordered_set<std::pair<Domain, Domain>> &attacks() const { return attacks_; }
+
+		bool onStateEnter(const SCState &state) {
+			if (semantics_.isFinal(state)) {
+				attacks_.insert(std::make_pair(
+					semantics_.layout().getMemoryValue(state, space_, ATTACK_WRITE_ADDRESS),
+					semantics_.layout().getMemoryValue(state, space_, ATTACK_READ_ADDRESS)));
+			}
+			return false;
+		}
+	};
+
+	AttackCollector collector(semantics, augmentedProgram.interestingSpace());
+	InPlaceDfs<SCSemantics, AttackCollector &>(semantics, collector).visit(semantics.initialState());
+
+	AttackSet result;
+	for (const auto &attack : collector.attacks()) {
+		assert(attack.first > 0 && static_cast<std::size_t>(attack.first) <= transitions.size());
+		assert(attack.second > 0 && static_cast<std::size_t>(attack.second) <= transitions.size());
+		result.insert(std::make_pair(transitions[attack.first - 1], transitions[attack.second - 1]));
+	}
+	return result;
+}
+
 } // namespace trench
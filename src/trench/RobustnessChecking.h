@@ -11,17 +11,98 @@
 
 #include <trench/config.h>
 
+#include <cstddef>
+#include <utility>
+#include <vector>
+
 #include <boost/unordered_set.hpp>
 
 namespace trench {
 
+class FenceFreeReachability;
+class MayAddresses;
+class OriginalStates;
 class Program;
 class State;
 class Thread;
 class Transition;
 
+/**
+ * Attacks given by the attacker's write and read, the attacker being the thread of the write.
+ */
+typedef boost::unordered_set<std::pair<Transition *, Transition *>> AttackSet;
+
+/**
+ * Optional inputs of isAttackFeasible().
+ */
+struct AttackCheckOptions {
+	/**
+	 * If nonzero, the attack is first searched for using bitstate hashing with a bit array
+	 * of this many bytes.
+	 */
+	std::size_t bitstateMemory;
+
+	/**
+	 * Whether the exact search follows a bitstate search finding nothing. Otherwise,
+	 * the attack is reported infeasible, which may be wrong.
+	 */
+	bool exact;
+
+	/**
+	 * If not NULL, the states of the original program, from which the exact search for
+	 * an attack with the attacker's write fixed starts instead of exploring them anew.
+	 */
+	const OriginalStates *originalStates;
+
+	/** If not NULL, the fence-free reachability of the attacker, used instead of being computed. */
+	const FenceFreeReachability *reachability;
+
+	/** If not NULL, the addresses the program may access, used instead of being computed. */
+	const MayAddresses *addresses;
+
+	/**
+	 * If not NULL, all the feasible attacks, as found by findFeasibleAttacks(). An attack
+	 * passing the static checks is then looked up in them instead of being searched for.
+	 */
+	const AttackSet *feasibleAttacks;
+
+	AttackCheckOptions():
+		bitstateMemory(0),
+		exact(true),
+		originalStates(NULL),
+		reachability(NULL),
+		addresses(NULL),
+		feasibleAttacks(NULL)
+	{}
+};
+
+/**
+ * Checks whether an attack on the program is feasible.
+ *
+ * Attacks are first checked statically: the attacker's read must be reachable from its write
+ * by fence-free transitions, and the addresses accessed must allow the happens-before cycle
+ * to close.
+ */
 bool isAttackFeasible(const Program &program, bool searchForTdrOnly,
                       Thread *attacker = NULL, Transition *attackWrite = NULL, Transition *attackRead = NULL,
-		      const boost::unordered_set<State *> &fenced = boost::unordered_set<State *>());
+		      const boost::unordered_set<State *> &fenced = boost::unordered_set<State *>(),
+		      const AttackCheckOptions &options = AttackCheckOptions());
+
+/**
+ * Checks whether any attack on the program is feasible.
+ */
+inline bool isAttackFeasible(const Program &program, bool searchForTdrOnly, const AttackCheckOptions &options) {
+	return isAttackFeasible(program, searchForTdrOnly, NULL, NULL, NULL, boost::unordered_set<State *>(), options);
+}
+
+/**
+ * Finds all the feasible attacks on the program at once, by a single exhaustive exploration
+ * of the program instrumented by reduce() for any attack and recording the attack made.
+ * The exploration is the sequential depth-first search keeping all the visited states,
+ * whatever search is configured.
+ *
+ * \return The feasible attacks.
+ */
+AttackSet findFeasibleAttacks(const Program &program, bool searchForTdrOnly);
 
 } // namespace trench
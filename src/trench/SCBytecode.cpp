@@ -0,0 +1,326 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#include "SCBytecode.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include "SCSemantics.h"
+
+namespace trench {
+
+SCBytecode::Code SCBytecode::compile(const Instruction &instruction, ThreadIndex thread) {
+	Code result;
+	result.begin = static_cast<uint32_t>(operations_.size());
+
+	temporaries_ = 0;
+	auto effect = compileInstruction(instruction, thread);
+	needs_.clear();
+	result.effect = effect;
+	result.temporaries = temporaries_;
+	if (partialOrderReduction_) {
+		switch (effect) {
+			case NO_FAVOURITE:
+				emit(SET_NO_FAVOURITE);
+				break;
+			case FAVOURITE:
+				emit(SET_FAVOURITE);
+				break;
+			case UNCHANGED:
+				break;
+		}
+	}
+
+	result.end = static_cast<uint32_t>(operations_.size());
+	return result;
+}
+
+SCBytecode::FavouriteEffect SCBytecode::compileInstruction(const Instruction &instruction, ThreadIndex thread) {
+	switch (instruction.mnemonic()) {
+		case Instruction::READ: {
+			auto read = instruction.as<Read>();
+			auto regOffset = layout_.getRegisterOffset(thread, layout_.census().getId(read->reg().get()));
+			std::size_t cellOffset = 0;
+			if (auto constant = read->address()->as<Constant>()) {
+				cellOffset = layout_.getCellOffset(read->space(), constant->value());
+			}
+			if (cellOffset != 0) {
+				temporaries_ = std::max<uint32_t>(temporaries_, 1);
+				emit(LOAD, 0, cellOffset);
+			} else {
+				compileExpression(*read->address(), thread, 0);
+				emit(LOAD_MEMORY, 0, read->space(), 0);
+			}
+			emit(STORE, regOffset, 0);
+			return NO_FAVOURITE;
+		}
+		case Instruction::WRITE: {
+			auto write = instruction.as<Write>();
+			compileExpression(*write->value(), thread, 0);
+			std::size_t cellOffset = 0;
+			if (auto constant = write->address()->as<Constant>()) {
+				cellOffset = layout_.getCellOffset(write->space(), constant->value());
+			}
+			if (cellOffset != 0) {
+				emit(STORE, cellOffset, 0);
+			} else {
+				compileExpression(*write->address(), thread, 1);
+				emit(STORE_MEMORY, write->space(), 1, 0);
+			}
+			return NO_FAVOURITE;
+		}
+		case Instruction::MFENCE: /* FALLTHROUGH */
+		case Instruction::NOOP: {
+			/* No-op under SC. */
+			return FAVOURITE;
+		}
+		case Instruction::LOCAL: {
+			auto local = instruction.as<Local>();
+			compileExpression(*local->value(), thread, 0);
+			emit(STORE, layout_.getRegisterOffset(thread, layout_.census().getId(local->reg().get())), 0);
+			return FAVOURITE;
+		}
+		case Instruction::CONDITION: {
+			auto condition = instruction.as<Condition>();
+			compileExpression(*condition->expression(), thread, 0);
+			emit(ASSUME, 0);
+			return FAVOURITE;
+		}
+		case Instruction::ATOMIC: {
+			/*
+			 * The favourite is set once, after all the instructions have been executed.
+			 * It is none if it was none after any of the instructions. If an instruction
+			 * was executed when nobody has set the favourite yet, it depends on the favourite
+			 * before the atomic instruction. That one is either none or the thread itself,
+			 * otherwise the thread could not execute anything, so it stays unchanged.
+			 */
+			auto current = UNCHANGED;
+			auto result = FAVOURITE;
+			for (const auto &instr : instruction.as<Atomic>()->instructions()) {
+				auto effect = compileInstruction(*instr, thread);
+				if (effect != UNCHANGED) {
+					current = effect;
+				}
+				if (current == NO_FAVOURITE) {
+					result = NO_FAVOURITE;
+				} else if (current == UNCHANGED && result == FAVOURITE) {
+					result = UNCHANGED;
+				}
+			}
+			return result;
+		}
+		case Instruction::LOCK: {
+			emit(LOCK);
+			return UNCHANGED;
+		}
+		case Instruction::UNLOCK: {
+			emit(UNLOCK);
+			return UNCHANGED;
+		}
+	}
+	assert(!"NEVER REACHED");
+	return UNCHANGED;
+}
+
+uint32_t SCBytecode::countTemporaries(const Expression &expression) {
+	auto i = needs_.find(&expression);
+	if (i != needs_.end()) {
+		return i->second;
+	}
+
+	uint32_t result = 1;
+	if (auto unary = expression.as<UnaryOperator>()) {
+		result = countTemporaries(*unary->operand());
+	} else if (auto binary = expression.as<BinaryOperator>()) {
+		auto left = countTemporaries(*binary->left());
+		auto right = countTemporaries(*binary->right());
+		result = left == right ? left + 1 : std::max(left, right);
+	}
+
+	needs_[&expression] = result;
+	return result;
+}
+
+/*
+ * Computes the value of the expression into t[temporary], using the temporaries
+ * from it up to, but not including, temporary + countTemporaries(expression).
+ */
+void SCBytecode::compileExpression(const Expression &expression, ThreadIndex thread, uint32_t temporary) {
+	temporaries_ = std::max(temporaries_, temporary + countTemporaries(expression));
+
+	switch (expression.kind()) {
+		case Expression::CONSTANT:
+			emit(CONSTANT, temporary, static_cast<uint32_t>(expression.as<Constant>()->value()));
+			return;
+		case Expression::REGISTER:
+			emit(LOAD, temporary, layout_.getRegisterOffset(thread, layout_.census().getId(expression.as<Register>())));
+			return;
+		case Expression::UNARY: {
+			auto unary = expression.as<UnaryOperator>();
+			compileExpression(*unary->operand(), thread, temporary);
+			switch (unary->kind()) {
+				case UnaryOperator::NOT:
+					emit(NOT, temporary, temporary);
+					return;
+			}
+			assert(!"NEVER REACHED");
+		}
+		case Expression::BINARY: {
+			auto binary = expression.as<BinaryOperator>();
+
+			/* The operand needing more temporaries goes first, the other one keeps its result aside. */
+			uint32_t left = temporary, right = temporary + 1;
+			if (countTemporaries(*binary->left()) < countTemporaries(*binary->right())) {
+				std::swap(left, right);
+				compileExpression(*binary->right(), thread, right);
+				compileExpression(*binary->left(), thread, left);
+			} else {
+				compileExpression(*binary->left(), thread, left);
+				compileExpression(*binary->right(), thread, right);
+			}
+
+			Opcode opcode;
+			switch (binary->kind()) {
+				case BinaryOperator::EQ:      opcode = EQ;      break;
+				case BinaryOperator::NEQ:     opcode = NEQ;     break;
+				case BinaryOperator::LT:      opcode = LT;      break;
+				case BinaryOperator::LEQ:     opcode = LEQ;     break;
+				case BinaryOperator::GT:      opcode = GT;      break;
+				case BinaryOperator::GEQ:     opcode = GEQ;     break;
+				case BinaryOperator::AND:     opcode = AND;     break;
+				case BinaryOperator::OR:      opcode = OR;      break;
+				case BinaryOperator::ADD:     opcode = ADD;     break;
+				case BinaryOperator::SUB:     opcode = SUB;     break;
+				case BinaryOperator::MUL:     opcode = MUL;     break;
+				case BinaryOperator::BIN_AND: opcode = BIN_AND; break;
+				default: {
+					assert(!"NEVER REACHED");
+					return;
+				}
+			}
+			emit(opcode, temporary, left, right);
+			return;
+		}
+		case Expression::CAN_ACCESS_MEMORY: {
+			emit(CAN_ACCESS_MEMORY, temporary);
+			return;
+		}
+	}
+	assert(!"NEVER REACHED");
+}
+
+void SCBytecode::emit(Opcode opcode, uint32_t a, uint32_t b, uint32_t c) {
+	operations_.push_back(Operation{opcode, a, b, c});
+}
+
+bool SCBytecode::run(const Code &code, SCState &state, ThreadIndex thread, SCUndoLog *log) const {
+	/* Most code needs just a few temporaries. */
+	Domain smallTemporaries[8];
+	std::vector<Domain> largeTemporaries;
+	Domain *t = smallTemporaries;
+	if (code.temporaries > sizeof(smallTemporaries) / sizeof(smallTemporaries[0])) {
+		largeTemporaries.resize(code.temporaries);
+		t = largeTemporaries.data();
+	}
+
+	for (auto i = code.begin; i != code.end; ++i) {
+		const auto &op = operations_[i];
+		switch (op.opcode) {
+			case CONSTANT:
+				t[op.a] = static_cast<Domain>(op.b);
+				break;
+			case LOAD:
+				t[op.a] = layout_.getValue(state, op.b);
+				break;
+			case LOAD_MEMORY:
+				t[op.a] = layout_.getMemoryValue(state, static_cast<Space>(op.b), t[op.c]);
+				break;
+			case STORE:
+				layout_.setValue(state, op.a, t[op.b], log);
+				break;
+			case STORE_MEMORY:
+				layout_.setMemoryValue(state, static_cast<Space>(op.a), t[op.b], t[op.c], log);
+				break;
+			case NOT:
+				t[op.a] = !t[op.b];
+				break;
+			case EQ:
+				t[op.a] = t[op.b] == t[op.c];
+				break;
+			case NEQ:
+				t[op.a] = t[op.b] != t[op.c];
+				break;
+			case LT:
+				t[op.a] = t[op.b] < t[op.c];
+				break;
+			case LEQ:
+				t[op.a] = t[op.b] <= t[op.c];
+				break;
+			case GT:
+				t[op.a] = t[op.b] > t[op.c];
+				break;
+			case GEQ:
+				t[op.a] = t[op.b] >= t[op.c];
+				break;
+			case AND:
+				t[op.a] = t[op.b] && t[op.c];
+				break;
+			case OR:
+				t[op.a] = t[op.b] || t[op.c];
+				break;
+			case ADD:
+				t[op.a] = t[op.b] + t[op.c];
+				break;
+			case SUB:
+				t[op.a] = t[op.b] - t[op.c];
+				break;
+			case MUL:
+				t[op.a] = t[op.b] * t[op.c];
+				break;
+			case BIN_AND:
+				t[op.a] = t[op.b] & t[op.c];
+				break;
+			case CAN_ACCESS_MEMORY: {
+				auto owner = layout_.getMemoryLockOwner(state);
+				t[op.a] = owner == SCStateLayout::NO_THREAD || owner == thread;
+				break;
+			}
+			case ASSUME:
+				if (!t[op.a]) {
+					return false;
+				}
+				break;
+			case LOCK:
+				if (layout_.getMemoryLockOwner(state) != SCStateLayout::NO_THREAD) {
+					return false;
+				}
+				layout_.setMemoryLockOwner(state, thread, log);
+				break;
+			case UNLOCK:
+				if (layout_.getMemoryLockOwner(state) != thread) {
+					return false;
+				}
+				layout_.setMemoryLockOwner(state, SCStateLayout::NO_THREAD, log);
+				break;
+			case SET_NO_FAVOURITE:
+				layout_.setFavourite(state, SCStateLayout::NO_THREAD, log);
+				break;
+			case SET_FAVOURITE:
+				layout_.setFavourite(state, thread, log);
+				break;
+		}
+	}
+
+	return true;
+}
+
+} // namespace trench
@@ -0,0 +1,136 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <trench/config.h>
+
+#include <cstdint>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+#include "Expression.h"
+#include "Instruction.h"
+
+namespace trench {
+
+class SCState;
+class SCStateLayout;
+class SCUndoLog;
+
+/**
+ * Instructions of a program compiled into code of a register machine operating on SC states.
+ *
+ * The machine has a file of temporaries, which hold the values of subexpressions.
+ * Subexpressions needing more temporaries are computed first (Sethi-Ullman numbering),
+ * so that the number of temporaries needed by code grows with the logarithm of the size
+ * of its expressions rather than with their depth.
+ * Registers and memory cells with constant addresses are accessed directly at their
+ * offsets in the state. The effect of an instruction on the favourite thread is
+ * computed at compile time, so that the code only sets the favourite when needed.
+ */
+class SCBytecode {
+public:
+	typedef uint16_t ThreadIndex;
+
+	enum Opcode : uint32_t {
+		CONSTANT,        /**< t[a] = b */
+		LOAD,            /**< t[a] = value at offset b */
+		LOAD_MEMORY,     /**< t[a] = memory of space b at address t[c] */
+		STORE,           /**< value at offset a = t[b] */
+		STORE_MEMORY,    /**< memory of space a at address t[b] = t[c] */
+		NOT,             /**< t[a] = !t[b] */
+		EQ,              /**< t[a] = t[b] == t[c], and likewise for other binary operators */
+		NEQ,
+		LT,
+		LEQ,
+		GT,
+		GEQ,
+		AND,
+		OR,
+		ADD,
+		SUB,
+		MUL,
+		BIN_AND,
+		CAN_ACCESS_MEMORY, /**< t[a] = whether the thread can access memory */
+		ASSUME,          /**< fail if t[a] is zero */
+		LOCK,            /**< acquire the memory lock or fail */
+		UNLOCK,          /**< release the memory lock or fail */
+		SET_NO_FAVOURITE,
+		SET_FAVOURITE,   /**< make the thread the favourite */
+	};
+
+	struct Operation {
+		Opcode opcode;
+		uint32_t a;
+		uint32_t b;
+		uint32_t c;
+	};
+
+	/**
+	 * Effect of an instruction on the favourite thread.
+	 */
+	enum FavouriteEffect {
+		NO_FAVOURITE,
+		FAVOURITE,
+		UNCHANGED,
+	};
+
+	/** Range of operations of compiled code. */
+	struct Code {
+		uint32_t begin;
+		uint32_t end;
+		FavouriteEffect effect;
+		uint32_t temporaries; /**< Number of temporaries used. */
+	};
+
+private:
+	const SCStateLayout &layout_;
+	bool partialOrderReduction_;
+	std::vector<Operation> operations_;
+
+	/** Number of temporaries used by the code being compiled. */
+	uint32_t temporaries_;
+
+	/** Numbers of temporaries needed by the subexpressions of the instruction being compiled. */
+	boost::unordered_map<const Expression *, uint32_t> needs_;
+
+public:
+	/**
+	 * \param layout                Layout of the states the code will operate on.
+	 * \param partialOrderReduction Whether the code must maintain the favourite thread.
+	 */
+	SCBytecode(const SCStateLayout &layout, bool partialOrderReduction):
+		layout_(layout), partialOrderReduction_(partialOrderReduction), temporaries_(0)
+	{}
+
+	/**
+	 * Compiles an instruction executed by the given thread.
+	 */
+	Code compile(const Instruction &instruction, ThreadIndex thread);
+
+	/**
+	 * Runs the compiled code, changing the state in place.
+	 *
+	 * \return True if the instruction was executable, false otherwise. In the latter case,
+	 *         the state may be changed partially.
+	 */
+	bool run(const Code &code, SCState &state, ThreadIndex thread, SCUndoLog *log) const;
+
+	std::size_t size() const { return operations_.size(); }
+
+private:
+	FavouriteEffect compileInstruction(const Instruction &instruction, ThreadIndex thread);
+	void compileExpression(const Expression &expression, ThreadIndex thread, uint32_t temporary);
+	uint32_t countTemporaries(const Expression &expression);
+	void emit(Opcode opcode, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0);
+};
+
+} // namespace trench
@@ -9,13 +9,202 @@
 
 #include "SCReachability.h"
 
+#include <cassert>
+
+#include "Benchmarking.h"
+#include "BitStateSet.h"
+#include "BoundedReachability.h"
+#include "CollapseStateSet.h"
+#include "Configuration.h"
+#include "HashCompactionSet.h"
+#include "OriginalStates.h"
 #include "Reachability.h"
 #include "SCSemantics.h"
+#include "SymbolicReachability.h"
 
 namespace trench {
 
-bool isInterestingStateSCReachable(const Program &program) {
-	return isFinalStateReachable(SCSemantics(program));
+namespace {
+
+template<class StateSet>
+bool isInterestingStateReachableSequentially(const SCSemantics &semantics, const std::vector<SCState> &roots, StateSet visited) {
+	if (Configuration::instance().inPlaceSearch()) {
+		return isFinalStateReachableInPlace(semantics, roots, std::move(visited));
+	} else {
+		return isFinalStateReachable(semantics, roots, std::move(visited));
+	}
+}
+
+template<class StateSet>
+bool isInterestingStateReachableSequentially(const SCSemantics &semantics, StateSet visited) {
+	return isInterestingStateReachableSequentially(semantics, {semantics.initialState()}, std::move(visited));
+}
+
+/**
+ * Searches with the configured backend, unless it is the explicit one.
+ *
+ * \param[in]  program   Program.
+ * \param[in]  semantics Its semantics.
+ * \param[in]  roots     States to start the explicit search preceding the symbolic one from.
+ * \param[out] complete  Whether the result is conclusive.
+ */
+bool isInterestingStateReachableByBackend(const Program &program, const SCSemantics &semantics, const std::vector<SCState> &roots, bool &complete) {
+	complete = false;
+
+	switch (Configuration::instance().backend()) {
+		case Configuration::EXPLICIT:
+			return false;
+		case Configuration::BDD: {
+			if (Configuration::instance().symbolicThreshold() > 0) {
+				/* Small state spaces are searched much faster explicitly. */
+				bool result = isFinalStateReachableInPlace(semantics, roots, Configuration::instance().symbolicThreshold(), complete);
+				if (complete) {
+					return result;
+				}
+			}
+			bool result = isInterestingStateSCReachableSymbolically(program, Configuration::instance().symbolicWidth(), Configuration::instance().bddNodesLimit(), complete);
+			if (complete) {
+				Statistics::instance().incSymbolicSearchesCount();
+			}
+			return result;
+		}
+		case Configuration::BMC:
+			/* Bounded model checking only finds attacks, proving them infeasible is left to the explicit search. */
+			if (isInterestingStateSCReachableBounded(program, Configuration::instance().symbolicWidth(), Configuration::instance().bmcDepth())) {
+				Statistics::instance().incBoundedFeasibleAttacksCount();
+				complete = true;
+				return true;
+			}
+			return false;
+		default:
+			assert(!"NEVER REACHED");
+	}
+	return false;
+}
+
+/**
+ * \return True if the sequential exact search of the semantics uses sleep sets.
+ */
+bool usesSleepSets(const SCSemantics &semantics) {
+	const auto &configuration = Configuration::instance();
+
+	/* Sleep sets refer to threads by their indices, which canonicalization permutes. */
+	return configuration.sleepSets() && !configuration.hashCompaction() && !configuration.collapseCompression() &&
+	       !semantics.layout().isSymmetric();
+}
+
+/**
+ * \return True if the configured exact search of the semantics can start from the states
+ *         in which the attacker has just made the attack's write.
+ */
+bool canSearchFromOriginalStates(const SCSemantics &semantics) {
+	const auto &configuration = Configuration::instance();
+
+	/* The external memory, breadth-first, best-first and sleep set searches start from the initial state only. */
+	return configuration.memoryLimit() == 0 && configuration.searchOrder() == Configuration::DEPTH_FIRST && !usesSleepSets(semantics);
+}
+
+bool isInterestingStateReachable(const Program &program, const SCSemantics &semantics, std::size_t bitstateMemory, std::size_t nworkers) {
+	if (bitstateMemory == 0) {
+		bool complete;
+		bool result = isInterestingStateReachableByBackend(program, semantics, {semantics.initialState()}, complete);
+		if (complete) {
+			return result;
+		}
+	}
+
+	if (bitstateMemory > 0) {
+		return isInterestingStateReachableSequentially(semantics, BitStateSet<SCState>(bitstateMemory));
+	}
+
+	if (Configuration::instance().memoryLimit() > 0) {
+		return isFinalStateReachableInExternalMemory(semantics, Configuration::instance().memoryLimit());
+	}
+
+	if (Configuration::instance().hashCompaction()) {
+		if (nworkers > 1) {
+			return isFinalStateReachableInParallel<SCSemantics, HashCompactionSet<SCState>>(semantics, nworkers);
+		} else {
+			return isInterestingStateReachableSequentially(semantics, HashCompactionSet<SCState>());
+		}
+	} else if (Configuration::instance().collapseCompression()) {
+		/* The interning tables are not thread-safe, so the search is sequential. */
+		return isInterestingStateReachableSequentially(semantics, CollapseStateSet(semantics.layout()));
+	} else {
+		switch (Configuration::instance().searchOrder()) {
+			case Configuration::DEPTH_FIRST:
+				break;
+			case Configuration::BREADTH_FIRST:
+				return isFinalStateReachableBreadthFirst(semantics, nworkers);
+			case Configuration::GREEDY:
+				return isFinalStateReachableBestFirst(semantics, true);
+			case Configuration::A_STAR:
+				return isFinalStateReachableBestFirst(semantics, false);
+			default:
+				assert(!"NEVER REACHED");
+		}
+
+		if (nworkers > 1) {
+			return isFinalStateReachableInParallel(semantics, nworkers);
+		} else if (usesSleepSets(semantics)) {
+			return isFinalStateReachableWithSleepSets(semantics);
+		} else {
+			return isInterestingStateReachableSequentially(semantics, boost::unordered_set<SCState>());
+		}
+	}
+}
+
+} // anonymous namespace
+
+bool isInterestingStateSCReachable(const Program &program, std::size_t bitstateMemory, std::size_t nworkers) {
+	SCSemantics semantics(program);
+	return isInterestingStateReachable(program, semantics, bitstateMemory, nworkers);
+}
+
+bool isInterestingStateSCReachable(const Program &program, const OriginalStates &originalStates, const Thread *attacker, const Transition *attackWrite) {
+	const auto &configuration = Configuration::instance();
+
+	SCSemantics semantics(program);
+
+	/* The states are only explored when the first attack searching from them needs them. */
+	if (!canSearchFromOriginalStates(semantics) || !originalStates.complete()) {
+		return isInterestingStateReachable(program, semantics, 0, 1);
+	}
+
+	auto roots = originalStates.getAttackStates(semantics, attacker, attackWrite);
+
+	bool complete;
+	bool result = isInterestingStateReachableByBackend(program, semantics, roots, complete);
+	if (complete) {
+		return result;
+	}
+
+	if (configuration.hashCompaction()) {
+		return isInterestingStateReachableSequentially(semantics, roots, HashCompactionSet<SCState>());
+	} else if (configuration.collapseCompression()) {
+		return isInterestingStateReachableSequentially(semantics, roots, CollapseStateSet(semantics.layout()));
+	} else {
+		return isInterestingStateReachableSequentially(semantics, roots, boost::unordered_set<SCState>());
+	}
+}
+
+bool isInterestingStateSCReachableStatelessly(const Program &program, const OriginalStates *originalStates, const Thread *attacker, const Transition *attackWrite, std::size_t nworkers) {
+	bool complete;
+	bool result;
+	{
+		/* The search computes its own reduction, which others would interfere with. */
+		SCSemantics semantics(program, false);
+		result = isFinalStateReachableStatelessly(semantics, Configuration::instance().statelessSearchLimit(), complete);
+	}
+
+	if (complete) {
+		Statistics::instance().incStatelessSearchesCount();
+		return result;
+	} else if (originalStates) {
+		return isInterestingStateSCReachable(program, *originalStates, attacker, attackWrite);
+	} else {
+		return isInterestingStateSCReachable(program, 0, nworkers);
+	}
 }
 
 } // namespace trench
@@ -11,10 +11,54 @@
 
 #include <trench/config.h>
 
+#include <cstddef>
+
 namespace trench {
 
+class OriginalStates;
 class Program;
+class Thread;
+class Transition;
+
+/**
+ * Checks whether the interesting state of the program is reachable under SC.
+ *
+ * With the BDD backend configured, the symbolic search is tried first, and with
+ * the BMC backend, bounded model checking. If it gives up, or bounded model checking
+ * finds nothing, the states are enumerated explicitly.
+ *
+ * \param program        Program.
+ * \param bitstateMemory If nonzero, the search uses bitstate hashing with a bit array
+ *                       of this many bytes. Such a search may miss reachable states,
+ *                       but the states it reaches are really reachable.
+ * \param nworkers       Number of threads exploring the states without bitstate hashing.
+ */
+bool isInterestingStateSCReachable(const Program &program, std::size_t bitstateMemory = 0, std::size_t nworkers = 1);
 
-bool isInterestingStateSCReachable(const Program &program);
+/**
+ * Checks whether the interesting state of the program made by reduce() for the given attack
+ * is reachable under SC, starting the search from the states in which the attacker has just
+ * made the attack's write, as computed from the shared states of the original program.
+ * The external memory, breadth-first, best-first and sleep set searches, and any search
+ * if the shared states are too many, start from the initial state instead.
+ * With the symbolic backend, the explicit search preceding the symbolic one starts from
+ * these states.
+ */
+bool isInterestingStateSCReachable(const Program &program, const OriginalStates &originalStates,
+                                   const Thread *attacker, const Transition *attackWrite);
+
+/**
+ * Checks whether the interesting state of the program is reachable under SC
+ * using the stateless search with dynamic partial order reduction. If the search
+ * visits more states than the configured limit, it gives up in favour of
+ * isInterestingStateSCReachable(), starting from the shared states of the original
+ * program if they are given, or from the initial state using nworkers threads.
+ *
+ * The threads of the program must be acyclic, and no instruction may reset
+ * the interesting memory cell to zero once it is nonzero.
+ */
+bool isInterestingStateSCReachableStatelessly(const Program &program, const OriginalStates *originalStates = NULL,
+                                              const Thread *attacker = NULL, const Transition *attackWrite = NULL,
+                                              std::size_t nworkers = 1);
 
 } // namespace trench
@@ -9,9 +9,10 @@
 
 #include "SCSemantics.h"
 
+#include <algorithm>
 #include <cassert>
-
-#include <boost/optional.hpp>
+#include <ostream>
+#include <sstream>
 
 #include "Configuration.h"
 #include "ProgramPrinting.h"
@@ -19,25 +20,294 @@
 
 namespace trench {
 
-std::ostream &operator<<(std::ostream &out, const SCState &state) {
-	for (const auto &threadAndState : state.controlStates()) {
-		out << "cs(" << threadAndState.first->name() << ")=" << threadAndState.second->name() << "\\n";
+SCStateLayout::SCStateLayout(const Program &program) {
+	census_.visit(program);
+	census_.addCell(program.interestingSpace(), program.interestingAddress());
+
+	assert(census_.threads().size() < NO_THREAD);
+
+	std::size_t offset = 0;
+
+	std::size_t componentBegin = 0;
+	auto closeComponent = [&]() {
+		if (componentBegin < offset) {
+			components_.push_back(Component{componentBegin, offset - componentBegin});
+		}
+		componentBegin = offset;
+	};
+
+	for (std::size_t thread = 0; thread < census_.threads().size(); ++thread) {
+		assert(census_.states(thread).size() <= static_cast<StateIndex>(-1));
+		controlStateOffsets_.push_back(offset);
+		offset += sizeof(StateIndex);
+	}
+
+	memoryLockOwnerOffset_ = offset;
+	offset += sizeof(ThreadIndex);
+
+	favouriteOffset_ = offset;
+	offset += sizeof(ThreadIndex);
+
+	closeComponent();
+
+	std::vector<std::size_t> cells(census_.cells().size());
+	for (std::size_t cell = 0; cell < cells.size(); ++cell) {
+		cells[cell] = cell;
+	}
+	std::stable_sort(cells.begin(), cells.end(), [this](std::size_t a, std::size_t b) {
+		return census_.cells()[a].first < census_.cells()[b].first;
+	});
+
+	cellOffsets_.resize(cells.size());
+	for (std::size_t i = 0; i < cells.size(); ++i) {
+		if (i > 0 && census_.cells()[cells[i]].first != census_.cells()[cells[i - 1]].first) {
+			closeComponent();
+		}
+		cellOffsets_[cells[i]] = offset;
+		offset += sizeof(Domain);
+	}
+	closeComponent();
+
+	registerOffsets_.resize(census_.threads().size() * census_.registers().size());
+	deadRegisterOffsets_.resize(census_.threads().size());
+
+	for (std::size_t thread = 0; thread < census_.threads().size(); ++thread) {
+		for (std::size_t reg : census_.registers(thread)) {
+			registerOffsets_[thread * census_.registers().size() + reg] = offset;
+			offset += sizeof(Domain);
+		}
+		closeComponent();
+		deadRegisterOffsets_[thread].resize(census_.states(thread).size());
+	}
+
+	size_ = offset;
+}
+
+
+void SCStateLayout::setLiveness(const Liveness &liveness) {
+	for (std::size_t thread = 0; thread < census_.threads().size(); ++thread) {
+		for (std::size_t state = 0; state < census_.states(thread).size(); ++state) {
+			const auto &live = liveness.getLiveRegisters(thread, state);
+			auto &dead = deadRegisterOffsets_[thread][state];
+
+			dead.clear();
+			for (std::size_t reg : census_.registers(thread)) {
+				if (!std::binary_search(live.begin(), live.end(), reg)) {
+					dead.push_back(getRegisterOffset(thread, reg));
+				}
+			}
+		}
 	}
-	for (const auto &addrAndValue : state.memoryValuation()) {
-		if (addrAndValue.second != 0) {
+}
+
+void SCStateLayout::setSymmetry(const Symmetry &symmetry) {
+	symmetryClasses_.clear();
+	for (const auto &threads : symmetry.classes()) {
+		symmetryClasses_.push_back(std::vector<ThreadIndex>(threads.begin(), threads.end()));
+	}
+}
+
+void SCStateLayout::canonicalize(SCState &state, SCUndoLog *log) const {
+	auto memoryLockOwner = getMemoryLockOwner(state);
+	auto favourite = getFavourite(state);
+
+	auto newMemoryLockOwner = memoryLockOwner;
+	auto newFavourite = favourite;
+
+	for (const auto &threads : symmetryClasses_) {
+		/* Interchangeable threads have the same registers. */
+		const auto &registers = census_.registers(threads.front());
+
+		auto less = [&](ThreadIndex a, ThreadIndex b) {
+			auto controlStateA = getControlStateIndex(state, a);
+			auto controlStateB = getControlStateIndex(state, b);
+			if (controlStateA != controlStateB) {
+				return controlStateA < controlStateB;
+			}
+			for (std::size_t reg : registers) {
+				auto valueA = getRegisterValue(state, a, reg);
+				auto valueB = getRegisterValue(state, b, reg);
+				if (valueA != valueB) {
+					return valueA < valueB;
+				}
+			}
+			if ((a == memoryLockOwner) != (b == memoryLockOwner)) {
+				return a == memoryLockOwner;
+			}
+			if ((a == favourite) != (b == favourite)) {
+				return a == favourite;
+			}
+			return false;
+		};
+
+		if (std::is_sorted(threads.begin(), threads.end(), less)) {
+			continue;
+		}
+
+		auto order = threads;
+		std::stable_sort(order.begin(), order.end(), less);
+
+		std::vector<StateIndex> controlStates;
+		std::vector<Domain> values;
+		for (auto thread : order) {
+			controlStates.push_back(getControlStateIndex(state, thread));
+			for (std::size_t reg : registers) {
+				values.push_back(getRegisterValue(state, thread, reg));
+			}
+		}
+
+		for (std::size_t i = 0; i < threads.size(); ++i) {
+			setControlStateIndex(state, threads[i], controlStates[i], log);
+			for (std::size_t j = 0; j < registers.size(); ++j) {
+				setRegisterValue(state, threads[i], registers[j], values[i * registers.size() + j], log);
+			}
+			if (order[i] == memoryLockOwner) {
+				newMemoryLockOwner = threads[i];
+			}
+			if (order[i] == favourite) {
+				newFavourite = threads[i];
+			}
+		}
+	}
+
+	if (newMemoryLockOwner != memoryLockOwner) {
+		setMemoryLockOwner(state, newMemoryLockOwner, log);
+	}
+	if (newFavourite != favourite) {
+		setFavourite(state, newFavourite, log);
+	}
+}
+
+Domain SCStateLayout::getMemoryValue(const SCState &state, Space space, Address address) const {
+	auto cell = census_.getCellId(space, address);
+	if (cell != Census::NO_ID) {
+		return state.get<Domain>(cellOffsets_[cell]);
+	}
+
+	auto offset = findOverflowCell(state, space, address);
+	if (offset < state.size()) {
+		auto cell = getOverflowCell(state, offset);
+		if (cell.space == space && cell.address == address) {
+			return cell.value;
+		}
+	}
+	return 0;
+}
+
+void SCStateLayout::setMemoryValue(SCState &state, Space space, Address address, Domain value, SCUndoLog *log) const {
+	auto cell = census_.getCellId(space, address);
+	if (cell != Census::NO_ID) {
+		write<Domain>(state, cellOffsets_[cell], value, log);
+		return;
+	}
+
+	auto offset = findOverflowCell(state, space, address);
+	bool found = false;
+	if (offset < state.size()) {
+		auto cell = getOverflowCell(state, offset);
+		found = cell.space == space && cell.address == address;
+	}
+
+	auto cellHash = [&](Domain value) -> std::size_t {
+		return mixHash(mixHash(space, address) ^ static_cast<uint32_t>(value));
+	};
+
+	if (found) {
+		auto valueOffset = offset + offsetof(OverflowCell, value);
+		state.toggleHash(cellHash(state.get<Domain>(valueOffset)));
+		if (value != 0) {
+			state.toggleHash(cellHash(value));
+			if (log) {
+				log->recordWrite(state, valueOffset, sizeof(Domain));
+			}
+			state.assign<Domain>(valueOffset, value);
+		} else {
+			/* Cells with zero values are not stored. */
+			if (log) {
+				log->recordErasure(state, offset, sizeof(OverflowCell));
+			}
+			state.erase(offset, sizeof(OverflowCell));
+		}
+	} else if (value != 0) {
+		state.toggleHash(cellHash(value));
+		if (log) {
+			log->recordInsertion(offset, sizeof(OverflowCell));
+		}
+		state.insert<Domain>(offset, value);
+		state.insert<Address>(offset, address);
+		state.insert<Space>(offset, space);
+	}
+}
+
+SCStateLayout::OverflowCell SCStateLayout::getOverflowCell(const SCState &state, std::size_t offset) const {
+	OverflowCell result;
+	result.space   = state.get<Space>(offset + offsetof(OverflowCell, space));
+	result.address = state.get<Address>(offset + offsetof(OverflowCell, address));
+	result.value   = state.get<Domain>(offset + offsetof(OverflowCell, value));
+	return result;
+}
+
+std::size_t SCStateLayout::findOverflowCell(const SCState &state, Space space, Address address) const {
+	assert((state.size() - size_) % sizeof(OverflowCell) == 0);
+
+	std::size_t first = 0;
+	std::size_t count = (state.size() - size_) / sizeof(OverflowCell);
+
+	while (count > 0) {
+		std::size_t step = count / 2;
+		auto cell = getOverflowCell(state, size_ + (first + step) * sizeof(OverflowCell));
+		if (std::make_pair(cell.space, cell.address) < std::make_pair(space, address)) {
+			first += step + 1;
+			count -= step + 1;
+		} else {
+			count = step;
+		}
+	}
+
+	return size_ + first * sizeof(OverflowCell);
+}
+
+void SCStateLayout::print(const SCState &state, std::ostream &out) const {
+	for (ThreadIndex thread = 0; thread < threadsCount(); ++thread) {
+		out << "cs(" << getThread(thread)->name() << ")=" << getControlState(state, thread)->name() << "\\n";
+	}
+
+	std::vector<OverflowCell> cells;
+	for (std::size_t cell = 0; cell < census_.cells().size(); ++cell) {
+		const auto &spaceAndAddress = census_.cells()[cell];
+		cells.push_back(OverflowCell{spaceAndAddress.first, spaceAndAddress.second, state.get<Domain>(cellOffsets_[cell])});
+	}
+	for (std::size_t offset = size_; offset < state.size(); offset += sizeof(OverflowCell)) {
+		cells.push_back(getOverflowCell(state, offset));
+	}
+	std::sort(cells.begin(), cells.end(), [](const OverflowCell &a, const OverflowCell &b) {
+		return std::make_pair(a.space, a.address) < std::make_pair(b.space, b.address);
+	});
+
+	for (const auto &cell : cells) {
+		if (cell.value != 0) {
 			out << "mem";
-			if (addrAndValue.first.first != 0) {
-				out << addrAndValue.first.first;
+			if (cell.space != 0) {
+				out << cell.space;
 			}
-			out << "[" << addrAndValue.first.second << "]=" << addrAndValue.second << "\\n";
+			out << "[" << cell.address << "]=" << cell.value << "\\n";
 		}
 	}
-	for (const auto &regAndValue : state.registerValuation()) {
-		if (regAndValue.second != 0) {
-			out << "reg[" << regAndValue.first.first->name() << "," << regAndValue.first.second->name() << "]=" << regAndValue.second << "\\n";
+
+	for (ThreadIndex thread = 0; thread < threadsCount(); ++thread) {
+		std::vector<std::pair<std::string, Domain>> registers;
+		for (std::size_t reg : census_.registers(thread)) {
+			auto value = getRegisterValue(state, thread, reg);
+			if (value != 0) {
+				registers.push_back(std::make_pair(census_.registers()[reg]->name(), value));
+			}
+		}
+		std::sort(registers.begin(), registers.end());
+
+		for (const auto &item : registers) {
+			out << "reg[" << getThread(thread)->name() << "," << item.first << "]=" << item.second << "\\n";
 		}
 	}
-	return out;
 }
 
 std::ostream &operator<<(std::ostream &out, const SCTransition &transition) {
@@ -45,216 +315,244 @@ std::ostream &operator<<(std::ostream &out, const SCTransition &transition) {
 	return out;
 }
 
-SCSemantics::SCSemantics(const Program &program):
-	program_(program)
+SCSemantics::SCSemantics(const Program &program, bool reduce):
+	program_(program),
+	partialOrderReduction_(reduce && Configuration::instance().partialOrderReduction()),
+	amplePartialOrderReduction_(reduce && Configuration::instance().amplePartialOrderReduction()),
+	layout_(program),
+	bytecode_(layout_, partialOrderReduction_)
 {
+	const auto &census = layout_.census();
+
 	if (Configuration::instance().livenessOptimization()) {
-		liveness_ = computeLiveness(program);
+		layout_.setLiveness(computeLiveness(program, census));
+	}
+
+	if (reduce && Configuration::instance().symmetryReduction()) {
+		layout_.setSymmetry(computeSymmetry(census));
+	}
+
+	if (!reduce || amplePartialOrderReduction_ || Configuration::instance().sleepSets() ||
+	    Configuration::instance().searchOrder() == Configuration::GREEDY ||
+	    Configuration::instance().searchOrder() == Configuration::A_STAR) {
+		accesses_ = computeAccesses(program, census);
+	}
+
+	transitions_.resize(census.threads().size());
+	for (std::size_t thread = 0; thread < census.threads().size(); ++thread) {
+		const auto &states = census.states(thread);
+		transitions_[thread].resize(states.size());
+		for (std::size_t state = 0; state < states.size(); ++state) {
+			for (const trench::Transition *transition : states[state]->out()) {
+				transitions_[thread][state].push_back(ThreadTransition{
+					transition->instruction().get(),
+					static_cast<SCStateLayout::StateIndex>(census.getId(transition->to())),
+					bytecode_.compile(*transition->instruction(), static_cast<SCStateLayout::ThreadIndex>(thread)),
+					makeTransitionId(thread, state, transitions_[thread][state].size())
+				});
+			}
+		}
 	}
 }
 
 SCSemantics::State SCSemantics::initialState() const {
-	SCState result;
+	/* Initial control states have index zero, all the rest is zero too. */
+	return SCState(layout_.size());
+};
 
-	for (auto thread : program_.threads()) {
-		result.setControlState(thread, thread->initialState());
+std::size_t SCSemantics::estimateDistanceToFinal(const State &state) const {
+	if (isFinal(state)) {
+		return 0;
 	}
 
+	/* Only a visible transition can make the state final. */
+	std::size_t result = Accesses::INFINITE_DISTANCE;
+	for (SCStateLayout::ThreadIndex thread = 0; thread < layout_.threadsCount(); ++thread) {
+		result = std::min(result, accesses_.getVisibleDistance(thread, layout_.getControlStateIndex(state, thread)));
+	}
 	return result;
-};
+}
 
-namespace {
-
-Domain evaluate(const SCState &state, const Thread *thread, const Expression &expression) {
-	switch (expression.kind()) {
-		case Expression::CONSTANT:
-			return expression.as<Constant>()->value();
-		case Expression::REGISTER:
-			return state.getRegisterValue(thread, expression.as<Register>());
-		case Expression::UNARY: {
-			auto unary = expression.as<UnaryOperator>();
-			auto operandValue = evaluate(state, thread, *unary->operand());
-			switch (unary->kind()) {
-				case UnaryOperator::NOT:
-					return !operandValue;
-			}
-			assert(!"NEVER REACHED");
+std::string SCSemantics::getName(const State &state) const {
+	std::ostringstream out;
+	layout_.print(state, out);
+	return out.str();
+}
+
+SCSemantics::TransitionCursor SCSemantics::getTransitionsFrom(const State &state) const {
+	TransitionCursor result;
+	if (amplePartialOrderReduction_) {
+		result.singleThread_ = findAmpleThread(state);
+		result.fallBack_ = true;
+	}
+	return result;
+}
+
+SCSemantics::TransitionCursor SCSemantics::getTransitionsFrom(const State &, SCStateLayout::ThreadIndex thread) const {
+	TransitionCursor result;
+	result.singleThread_ = thread;
+	return result;
+}
+
+SCStateLayout::ThreadIndex SCSemantics::findAmpleThread(const State &state) const {
+	/* Leave the states where the favourite or the lock restrict the threads to the other reduction. */
+	if (layout_.getFavourite(state) != SCStateLayout::NO_THREAD ||
+	    layout_.getMemoryLockOwner(state) != SCStateLayout::NO_THREAD) {
+		return SCStateLayout::NO_THREAD;
+	}
+
+	for (SCStateLayout::ThreadIndex thread = 0; thread < layout_.threadsCount(); ++thread) {
+		auto controlState = layout_.getControlStateIndex(state, thread);
+		auto ntransitions = transitions_[thread][controlState].size();
+		if (ntransitions == 0) {
+			continue;
+		}
+
+		/*
+		 * Visible transitions may make a final state reachable, and back edges
+		 * may close a cycle of the state space on which the other threads are
+		 * postponed forever. With the favourite reduction, a transition making
+		 * the thread the favourite or the owner of the lock gives it the control
+		 * until its next memory access, which it may never reach if it blocks.
+		 */
+		bool por = partialOrderReduction_;
+		bool ample = !por || !accesses_.mayLock(thread, controlState);
+		for (std::size_t i = 0; i < ntransitions && ample; ++i) {
+			ample = !accesses_.isVisible(thread, controlState, i) && !accesses_.isBackEdge(thread, controlState, i) &&
+				(!por || transitions_[thread][controlState][i].code.effect == SCBytecode::NO_FAVOURITE);
 		}
-		case Expression::BINARY: {
-			auto binary = expression.as<BinaryOperator>();
-			auto leftValue = evaluate(state, thread, *binary->left());
-			auto rightValue = evaluate(state, thread, *binary->right());
-			switch (binary->kind()) {
-				case BinaryOperator::EQ:
-					return leftValue == rightValue;
-				case BinaryOperator::NEQ:
-					return leftValue != rightValue;
-				case BinaryOperator::LT:
-					return leftValue < rightValue;
-				case BinaryOperator::LEQ:
-					return leftValue <= rightValue;
-				case BinaryOperator::GT:
-					return leftValue > rightValue;
-				case BinaryOperator::GEQ:
-					return leftValue >= rightValue;
-				case BinaryOperator::AND:
-					return leftValue && rightValue;
-				case BinaryOperator::OR:
-					return leftValue || rightValue;
-				case BinaryOperator::ADD:
-					return leftValue + rightValue;
-				case BinaryOperator::SUB:
-					return leftValue - rightValue;
-				case BinaryOperator::MUL:
-					return leftValue * rightValue;
-				case BinaryOperator::BIN_AND:
-					return leftValue & rightValue;
+
+		/* Nothing the other threads can ever do may enable, disable or be affected by the transitions. */
+		const auto &local = accesses_.getLocalAccesses(thread, controlState);
+		for (SCStateLayout::ThreadIndex other = 0; other < layout_.threadsCount() && ample; ++other) {
+			if (other != thread) {
+				ample = !local.conflictsWith(accesses_.getReachableAccesses(other, layout_.getControlStateIndex(state, other)));
 			}
-			assert(!"NEVER REACHED");
 		}
-		case Expression::CAN_ACCESS_MEMORY: {
-			return state.memoryLockOwner() == NULL || state.memoryLockOwner() == thread;
+
+		if (ample) {
+			return thread;
+		}
+	}
+
+	return SCStateLayout::NO_THREAD;
+}
+
+bool SCSemantics::areIndependent(TransitionId a, TransitionId b) const {
+	std::size_t threadA = a >> 48, stateA = (a >> 16) & 0xffffffff, indexA = a & 0xffff;
+	std::size_t threadB = b >> 48, stateB = (b >> 16) & 0xffffffff, indexB = b & 0xffff;
+
+	if (threadA == threadB) {
+		return false;
+	}
+
+	/*
+	 * With the favourite reduction, making a thread the favourite or the owner
+	 * of the lock disables the transitions of all the other threads.
+	 */
+	if (partialOrderReduction_) {
+		if (transitions_[threadA][stateA][indexA].code.effect != SCBytecode::NO_FAVOURITE ||
+		    transitions_[threadB][stateB][indexB].code.effect != SCBytecode::NO_FAVOURITE ||
+		    accesses_.mayLock(threadA, stateA, indexA) ||
+		    accesses_.mayLock(threadB, stateB, indexB)) {
+			return false;
 		}
 	}
-	assert(!"NEVER REACHED");
+
+	/*
+	 * A transition is compared by the accesses of all the transitions from its control state.
+	 * Otherwise, a thread choosing a transition not touching the memory would be independent
+	 * from the threads that could enable the alternative, which would then never be explored.
+	 */
+	return !accesses_.getLocalAccesses(threadA, stateA).conflictsWith(accesses_.getLocalAccesses(threadB, stateB));
 }
 
-boost::optional<SCState> execute(const SCState &state, const Thread *thread, const Instruction &instruction) {
-	switch (instruction.mnemonic()) {
-		case Instruction::READ: {
-			auto read = instruction.as<Read>();
-			auto result = state;
-			result.setRegisterValue(
-				thread,
-				read->reg().get(),
-				state.getMemoryValue(
-					read->space(),
-					evaluate(state, thread, *read->address())
-				));
-			if (Configuration::instance().partialOrderReduction()) {
-				result.setFavourite(NULL);
+template<class Try>
+bool SCSemantics::findNextTransition(const State &state, TransitionCursor &cursor, Try tryTransition) const {
+	if (cursor.singleThread_ != SCStateLayout::NO_THREAD) {
+		auto thread = cursor.singleThread_;
+		const auto &transitions = transitions_[thread][layout_.getControlStateIndex(state, thread)];
+		while (cursor.transition_ < transitions.size()) {
+			const auto &transition = transitions[cursor.transition_++];
+			if (tryTransition(thread, transition)) {
+				cursor.found_ = true;
+				cursor.id_ = transition.id;
+				return true;
 			}
-			return result;
 		}
-		case Instruction::WRITE: {
-			auto write = instruction.as<Write>();
-			auto result = state;
-			result.setMemoryValue(
-				write->space(),
-				evaluate(state, thread, *write->address()),
-				evaluate(state, thread, *write->value())
-			);
-			if (Configuration::instance().partialOrderReduction()) {
-				result.setFavourite(NULL);
-			}
-			return result;
+		if (!cursor.fallBack_ || cursor.found_) {
+			return false;
 		}
-		case Instruction::MFENCE: /* FALLTHROUGH */
-		case Instruction::NOOP: {
-			/* No-op under SC. */
-			auto result = state;
-			if (Configuration::instance().partialOrderReduction()) {
-				result.setFavourite(thread);
+
+		/* The ample set is empty: explore all the threads. */
+		cursor = TransitionCursor();
+	}
+
+	auto memoryLockOwner = layout_.getMemoryLockOwner(state);
+	auto favourite = layout_.getFavourite(state);
+
+	for (; cursor.thread_ < layout_.threadsCount(); ++cursor.thread_, cursor.transition_ = 0) {
+		auto thread = cursor.thread_;
+		if (!partialOrderReduction_ ||
+		    ((memoryLockOwner == SCStateLayout::NO_THREAD || memoryLockOwner == thread) &&
+		     (favourite == SCStateLayout::NO_THREAD || favourite == thread))) {
+			const auto &transitions = transitions_[thread][layout_.getControlStateIndex(state, thread)];
+			while (cursor.transition_ < transitions.size()) {
+				const auto &transition = transitions[cursor.transition_++];
+				if (tryTransition(thread, transition)) {
+					cursor.id_ = transition.id;
+					return true;
+				}
 			}
-			return result;
 		}
-		case Instruction::LOCAL: {
-			auto local = instruction.as<Local>();
-			auto result = state;
-			result.setRegisterValue(
-				thread,
-				local->reg().get(),
-				evaluate(state, thread, *local->value())
-			);
-			if (Configuration::instance().partialOrderReduction()) {
-				result.setFavourite(thread);
-			}
-			return result;
+	}
+
+	return false;
+}
+
+bool SCSemantics::getNextTransition(const State &state, TransitionCursor &cursor, Transition &transition) const {
+	return findNextTransition(state, cursor, [&](SCStateLayout::ThreadIndex thread, const ThreadTransition &threadTransition) {
+		transition.destination_ = state;
+		if (!bytecode_.run(threadTransition.code, transition.destination_, thread, NULL)) {
+			return false;
 		}
-		case Instruction::CONDITION: {
-			auto condition = instruction.as<Condition>();
-			if (!evaluate(state, thread, *condition->expression())) {
-				return boost::none;
-			}
-			auto result = state;
-			if (Configuration::instance().partialOrderReduction()) {
-				result.setFavourite(thread);
-			}
-			return result;
+
+		layout_.setControlStateIndex(transition.destination_, thread, threadTransition.destination);
+
+		if (Configuration::instance().livenessOptimization()) {
+			layout_.resetDeadRegisters(transition.destination_, thread, threadTransition.destination);
 		}
-		case Instruction::ATOMIC: {
-			auto atomic = instruction.as<Atomic>();
-			auto result = state;
-			auto newFavourite = thread;
-			for (const auto &instr : atomic->instructions()) {
-				if (auto destination = execute(result, thread, *instr)) {
-					result = *destination;
-					if (result.favourite() == NULL) {
-						newFavourite = NULL;
-					}
-				} else {
-					return boost::none;
-				}
-			}
-			if (Configuration::instance().partialOrderReduction()) {
-				result.setFavourite(newFavourite);
-			}
-			return result;
+
+		if (layout_.isSymmetric()) {
+			layout_.canonicalize(transition.destination_);
 		}
-		case Instruction::LOCK: {
-			if (state.memoryLockOwner() == NULL) {
-				auto result = state;
-				result.setMemoryLockOwner(thread);
-				return result;
-			} else {
-				return boost::none;
-			}
+
+		transition.instruction_ = threadTransition.instruction;
+		transition.id_ = threadTransition.id;
+		return true;
+	});
+}
+
+bool SCSemantics::applyNextTransition(State &state, TransitionCursor &cursor, UndoLog &log) const {
+	return findNextTransition(state, cursor, [&](SCStateLayout::ThreadIndex thread, const ThreadTransition &threadTransition) {
+		auto mark = log.mark(state);
+		if (!bytecode_.run(threadTransition.code, state, thread, &log)) {
+			log.undo(state, mark);
+			return false;
 		}
-		case Instruction::UNLOCK: {
-			if (state.memoryLockOwner() == thread) {
-				auto result = state;
-				result.setMemoryLockOwner(NULL);
-				return result;
-			} else {
-				return boost::none;
-			}
+
+		layout_.setControlStateIndex(state, thread, threadTransition.destination, &log);
+
+		if (Configuration::instance().livenessOptimization()) {
+			layout_.resetDeadRegisters(state, thread, threadTransition.destination, &log);
 		}
-	}
-	assert(!"NEVER REACHED");
-}
 
-} // anonymous namespace
-
-std::vector<SCSemantics::Transition> SCSemantics::getTransitionsFrom(const State &state) const {
-	std::vector<Transition> result;
-
-	for (const auto &threadAndState : state.controlStates()) {
-		auto thread = threadAndState.first;
-		if (!Configuration::instance().partialOrderReduction() ||
-		    ((state.memoryLockOwner() == NULL || state.memoryLockOwner() == thread) &&
-		     (state.favourite() == NULL || state.favourite() == thread))) {
-			auto controlState = threadAndState.second;
-			for (auto transition : controlState->out()) {
-				if (auto destination = execute(state, thread, *transition->instruction())) {
-					destination->setControlState(thread, transition->to());
-
-					if (Configuration::instance().livenessOptimization()) {
-						const auto &live = liveness_.getLiveRegisters(transition->to());
-						destination->registerValuation().filterOut(
-							[&](const std::pair<const Thread *, const Register *> &threadAndRegister){
-								return threadAndRegister.first == thread &&
-								       std::find(live.begin(), live.end(), threadAndRegister.second) == live.end();
-							}
-						);
-					}
-
-					result.push_back(SCTransition(state, std::move(*destination), transition->instruction().get()));
-				}
-			}
+		if (layout_.isSymmetric()) {
+			layout_.canonicalize(state, &log);
 		}
-	}
 
-	return result;
+		return true;
+	});
 }
 
 } // namespace trench
@@ -11,104 +11,620 @@
 
 #include <trench/config.h>
 
-#include "BitTwiddling.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+#include "Accesses.h"
+#include "Census.h"
+#include "HashMix.h"
 #include "Liveness.h"
 #include "Program.h"
-#include "SmallMap.h"
+#include "SCBytecode.h"
 #include "State.h"
+#include "Symmetry.h"
 
 namespace trench {
 
+/**
+ * State of a program under SC semantics, packed into a contiguous byte vector.
+ *
+ * The meaning of the bytes is defined by SCStateLayout. The state only knows
+ * how to read and write fixed-width fields at given offsets and maintains
+ * a hash of its contents incrementally: the hash is the XOR of the hashes
+ * of all nonzero fields (Zobrist hashing). The hash of a field is a strong
+ * 64-bit mix of its offset and value, so that the hash of the state can serve
+ * as its fingerprint.
+ */
 class SCState {
-	SmallMap<const Thread *, const State *> controlStates_;
-	SmallMap<std::pair<Space, Address>, Domain> memoryValuation_;
-	SmallMap<std::pair<const Thread *, const Register *>, Domain> registerValuation_;
-	const Thread *memoryLockOwner_;
-	const Thread *favourite_;
+	std::vector<unsigned char> bytes_;
+	std::size_t hash_;
+
 public:
-	SCState(): memoryLockOwner_(NULL), favourite_(NULL) {}
+	SCState(): hash_(0) {}
+
+	explicit
+	SCState(std::size_t size): bytes_(size), hash_(0) {}
+
+	/**
+	 * Restores a state from its bytes and hash, as saved earlier.
+	 */
+	SCState(std::vector<unsigned char> bytes, std::size_t hash): bytes_(std::move(bytes)), hash_(hash) {}
+
+	const std::vector<unsigned char> &bytes() const { return bytes_; }
+
+	template<class T>
+	T get(std::size_t offset) const {
+		T result;
+		std::memcpy(&result, &bytes_[offset], sizeof(T));
+		return result;
+	}
+
+	template<class T>
+	void set(std::size_t offset, T value) {
+		T oldValue = get<T>(offset);
+		if (oldValue != value) {
+			hash_ ^= hashField(offset, oldValue) ^ hashField(offset, value);
+			std::memcpy(&bytes_[offset], &value, sizeof(T));
+		}
+	}
+
+	/**
+	 * Writes a value at the given offset without updating the hash.
+	 * Used for fields whose offsets are not fixed: their contribution to the hash
+	 * must be maintained by the caller using toggleHash().
+	 */
+	template<class T>
+	void assign(std::size_t offset, T value) {
+		std::memcpy(&bytes_[offset], &value, sizeof(T));
+	}
+
+	/**
+	 * Inserts a field at the given offset without updating the hash.
+	 */
+	template<class T>
+	void insert(std::size_t offset, T value) {
+		bytes_.insert(bytes_.begin() + offset, sizeof(T), 0);
+		assign(offset, value);
+	}
+
+	/**
+	 * Overwrites bytes at the given offset without updating the hash.
+	 */
+	void assign(std::size_t offset, const unsigned char *data, std::size_t size) {
+		std::memcpy(&bytes_[offset], data, size);
+	}
 
-	const SmallMap<const Thread *, const State *> &controlStates() const { return controlStates_; }
-	void setControlState(const Thread *thread, const State *state) { controlStates_.set(thread, state); }
+	/**
+	 * Inserts bytes at the given offset without updating the hash.
+	 */
+	void insert(std::size_t offset, const unsigned char *data, std::size_t size) {
+		bytes_.insert(bytes_.begin() + offset, data, data + size);
+	}
 
-	const SmallMap<std::pair<Space, Address>, Domain> &memoryValuation() const { return memoryValuation_; }
-	void setMemoryValue(Space space, Domain address, Domain value) { memoryValuation_.set(std::make_pair(space, address), value); }
-	Domain getMemoryValue(Space space, Domain address) const { return memoryValuation_.get(std::make_pair(space, address)); }
+	/**
+	 * Removes the given number of bytes at the given offset without updating the hash.
+	 */
+	void erase(std::size_t offset, std::size_t size) {
+		bytes_.erase(bytes_.begin() + offset, bytes_.begin() + offset + size);
+	}
 
-	SmallMap<std::pair<const Thread *, const Register *>, Domain> &registerValuation() { return registerValuation_; }
-	const SmallMap<std::pair<const Thread *, const Register *>, Domain> &registerValuation() const { return registerValuation_; }
-	void setRegisterValue(const Thread *thread, const Register *reg, Domain value) { registerValuation_.set(std::make_pair(thread, reg), value); }
-	Domain getRegisterValue(const Thread *thread, const Register *reg) const { return registerValuation_.get(std::make_pair(thread, reg)); }
+	/**
+	 * Mixes the given hash into the hash of the state.
+	 */
+	void toggleHash(std::size_t hash) { hash_ ^= hash; }
 
-	const Thread *memoryLockOwner() const { return memoryLockOwner_; }
-	void setMemoryLockOwner(const Thread *thread) { memoryLockOwner_ = thread; }
+	std::size_t size() const { return bytes_.size(); }
 
-	const Thread *favourite() const { return favourite_; }
-	void setFavourite(const Thread *thread) { favourite_ = thread; }
+	std::size_t hash() const { return hash_; }
 
-	std::size_t hash() const {
-		return ror(controlStates_.hash(), 7) ^
-		       ror(memoryValuation_.hash(), 13) ^
-		       ror(registerValuation_.hash(), 17) ^
-		       reinterpret_cast<uintptr_t>(memoryLockOwner_) ^
-		       (reinterpret_cast<uintptr_t>(favourite_) << 8); }
+private:
+	template<class T>
+	static std::size_t hashField(std::size_t offset, T value) {
+		if (value == T()) {
+			return 0;
+		}
+		assert(offset <= UINT32_MAX && sizeof(T) <= sizeof(uint32_t));
+		return mixHash(static_cast<uint32_t>(offset), static_cast<uint32_t>(value));
+	}
 };
 
 inline bool operator==(const SCState &a, const SCState &b) {
-	return a.controlStates() == b.controlStates() &&
-	       a.memoryValuation() == b.memoryValuation() &&
-	       a.registerValuation() == b.registerValuation() &&
-	       a.memoryLockOwner() == b.memoryLockOwner() &&
-	       a.favourite() == b.favourite();
+	return a.hash() == b.hash() &&
+	       a.size() == b.size() &&
+	       std::memcmp(a.bytes().data(), b.bytes().data(), a.size()) == 0;
 }
 
 inline std::size_t hash_value(const trench::SCState &state) {
 	return state.hash();
 }
 
-std::ostream &operator<<(std::ostream &out, const SCState &state);
+/**
+ * Log of changes made to an SCState, allowing to undo them.
+ *
+ * A change is recorded before it is made: for an overwrite or an erasure,
+ * the old bytes are saved. Undoing restores the bytes in reverse order
+ * and the hash the state had when the mark was taken.
+ */
+class SCUndoLog {
+public:
+	/** Maximal number of bytes changed by a single recorded change. */
+	static const std::size_t MAX_CHANGE_SIZE = 12;
+
+	struct Mark {
+		std::size_t position;
+		std::size_t hash;
+	};
+
+private:
+	enum ChangeKind : uint8_t { WRITE, INSERTION, ERASURE };
+
+	struct Change {
+		uint32_t offset;
+		ChangeKind kind;
+		uint8_t size;
+		unsigned char bytes[MAX_CHANGE_SIZE];
+	};
+
+	std::vector<Change> changes_;
+
+public:
+	/**
+	 * \return Mark to which the changes made to the state from now on can be undone.
+	 */
+	Mark mark(const SCState &state) const { return Mark{changes_.size(), state.hash()}; }
+
+	void recordWrite(const SCState &state, std::size_t offset, std::size_t size) {
+		record(WRITE, offset, size, &state.bytes()[offset]);
+	}
+
+	void recordInsertion(std::size_t offset, std::size_t size) {
+		record(INSERTION, offset, size, NULL);
+	}
+
+	void recordErasure(const SCState &state, std::size_t offset, std::size_t size) {
+		record(ERASURE, offset, size, &state.bytes()[offset]);
+	}
+
+	/**
+	 * Undoes the changes recorded since the given mark was taken and forgets them.
+	 */
+	void undo(SCState &state, const Mark &mark) {
+		while (changes_.size() > mark.position) {
+			const auto &change = changes_.back();
+			switch (change.kind) {
+				case WRITE:
+					state.assign(change.offset, change.bytes, change.size);
+					break;
+				case INSERTION:
+					state.erase(change.offset, change.size);
+					break;
+				case ERASURE:
+					state.insert(change.offset, change.bytes, change.size);
+					break;
+			}
+			changes_.pop_back();
+		}
+		state.toggleHash(state.hash() ^ mark.hash);
+	}
+
+private:
+	void record(ChangeKind kind, std::size_t offset, std::size_t size, const unsigned char *bytes) {
+		assert(size <= MAX_CHANGE_SIZE);
+		changes_.push_back(Change{static_cast<uint32_t>(offset), kind, static_cast<uint8_t>(size), {}});
+		if (bytes) {
+			std::memcpy(changes_.back().bytes, bytes, size);
+		}
+	}
+};
+
+/**
+ * Describes where the components of a program's SC states live inside SCState's byte vector.
+ *
+ * The byte vector starts with a fixed-size part:
+ *
+ *   - the id of the control state of each thread,
+ *   - the id of the thread owning the memory lock (plus one, zero if nobody owns it),
+ *   - the id of the favourite thread (plus one, zero if there is none),
+ *   - the values of the memory cells whose addresses are constants in the program,
+ *     grouped by space,
+ *   - the values of the registers of each thread.
+ *
+ * The fixed-size part is followed by a list of (space, address, value) triples
+ * for the nonzero memory cells whose addresses only become known at run time.
+ * The list is sorted by space and address, so that equal states have equal bytes.
+ *
+ * Threads, control states, registers and cells are identified by their ids in the census.
+ *
+ * All the setters optionally record the changes they make into an undo log.
+ *
+ * The fixed-size part is split into components which tend to change independently:
+ * the control part (control states, lock owner and favourite), the cells of each space,
+ * and the registers of each thread.
+ */
+class SCStateLayout {
+public:
+	typedef uint16_t ThreadIndex;
+	typedef uint16_t StateIndex;
+
+	static const ThreadIndex NO_THREAD = static_cast<ThreadIndex>(-1);
+
+	struct Component {
+		std::size_t offset;
+		std::size_t size;
+	};
+
+private:
+	Census census_;
+
+	std::vector<std::size_t> controlStateOffsets_;
+	std::size_t memoryLockOwnerOffset_;
+	std::size_t favouriteOffset_;
+
+	/** Offsets of memory cells, indexed by cell id. */
+	std::vector<std::size_t> cellOffsets_;
+
+	/** Offsets of registers, indexed by thread id times the number of registers plus register id. Zero if not used. */
+	std::vector<std::size_t> registerOffsets_;
 
+	/** Offsets of dead registers, indexed by thread id and state id. */
+	std::vector<std::vector<std::vector<std::size_t>>> deadRegisterOffsets_;
+
+	std::size_t size_;
+
+	std::vector<Component> components_;
+
+	/** Classes of interchangeable threads. */
+	std::vector<std::vector<ThreadIndex>> symmetryClasses_;
+
+public:
+	explicit
+	SCStateLayout(const Program &program);
+
+	/**
+	 * \return Symbol table of the program, giving the ids used by the layout.
+	 */
+	const Census &census() const { return census_; }
+
+	/**
+	 * \return Size of the fixed part of a state in bytes.
+	 */
+	std::size_t size() const { return size_; }
+
+	/**
+	 * \return Nonempty components of the fixed part of a state, in the order of their offsets.
+	 */
+	const std::vector<Component> &components() const { return components_; }
+
+	std::size_t threadsCount() const { return controlStateOffsets_.size(); }
+	const Thread *getThread(ThreadIndex thread) const { return census_.threads()[thread]; }
+
+	StateIndex getControlStateIndex(const SCState &state, ThreadIndex thread) const {
+		return state.get<StateIndex>(controlStateOffsets_[thread]);
+	}
+	void setControlStateIndex(SCState &state, ThreadIndex thread, StateIndex controlState, SCUndoLog *log = NULL) const {
+		write<StateIndex>(state, controlStateOffsets_[thread], controlState, log);
+	}
+
+	const State *getControlState(const SCState &state, ThreadIndex thread) const {
+		return census_.states(thread)[getControlStateIndex(state, thread)];
+	}
+
+	ThreadIndex getMemoryLockOwner(const SCState &state) const {
+		return state.get<ThreadIndex>(memoryLockOwnerOffset_) - 1;
+	}
+	void setMemoryLockOwner(SCState &state, ThreadIndex thread, SCUndoLog *log = NULL) const {
+		write<ThreadIndex>(state, memoryLockOwnerOffset_, thread + 1, log);
+	}
+
+	ThreadIndex getFavourite(const SCState &state) const {
+		return state.get<ThreadIndex>(favouriteOffset_) - 1;
+	}
+	void setFavourite(SCState &state, ThreadIndex thread, SCUndoLog *log = NULL) const {
+		write<ThreadIndex>(state, favouriteOffset_, thread + 1, log);
+	}
+
+	Domain getMemoryValue(const SCState &state, Space space, Address address) const;
+	void setMemoryValue(SCState &state, Space space, Address address, Domain value, SCUndoLog *log = NULL) const;
+
+	/**
+	 * Calls the given functor with the space, the address and the value of each memory cell
+	 * having a nonzero value in the given state.
+	 */
+	template<class Function>
+	void forEachMemoryCell(const SCState &state, Function function) const {
+		for (std::size_t cell = 0; cell < cellOffsets_.size(); ++cell) {
+			if (auto value = state.get<Domain>(cellOffsets_[cell])) {
+				function(census_.cells()[cell].first, census_.cells()[cell].second, value);
+			}
+		}
+		for (std::size_t offset = size_; offset < state.size(); offset += sizeof(OverflowCell)) {
+			auto cell = getOverflowCell(state, offset);
+			function(cell.space, cell.address, cell.value);
+		}
+	}
+
+	Domain getRegisterValue(const SCState &state, ThreadIndex thread, std::size_t reg) const {
+		return state.get<Domain>(getRegisterOffset(thread, reg));
+	}
+	void setRegisterValue(SCState &state, ThreadIndex thread, std::size_t reg, Domain value, SCUndoLog *log = NULL) const {
+		write<Domain>(state, getRegisterOffset(thread, reg), value, log);
+	}
+
+	/**
+	 * \return Offset of the value of the given register of the given thread.
+	 */
+	std::size_t getRegisterOffset(ThreadIndex thread, std::size_t reg) const {
+		auto result = registerOffsets_[thread * census_.registers().size() + reg];
+		assert(result != 0);
+		return result;
+	}
+
+	/**
+	 * \return Offset of the value of the given memory cell if it belongs to the fixed part, zero otherwise.
+	 */
+	std::size_t getCellOffset(Space space, Address address) const {
+		auto cell = census_.getCellId(space, address);
+		return cell != Census::NO_ID ? cellOffsets_[cell] : 0;
+	}
+
+	/**
+	 * \return Value of the register or the memory cell at the given offset of the fixed part.
+	 */
+	Domain getValue(const SCState &state, std::size_t offset) const {
+		return state.get<Domain>(offset);
+	}
+	void setValue(SCState &state, std::size_t offset, Domain value, SCUndoLog *log = NULL) const {
+		write<Domain>(state, offset, value, log);
+	}
+
+	/**
+	 * Sets the registers of the thread that are dead in the given control state to zero.
+	 */
+	void resetDeadRegisters(SCState &state, ThreadIndex thread, StateIndex controlState, SCUndoLog *log = NULL) const {
+		for (auto offset : deadRegisterOffsets_[thread][controlState]) {
+			write<Domain>(state, offset, 0, log);
+		}
+	}
+
+	/**
+	 * Marks the registers of the threads which are not live according to the given liveness information as dead.
+	 */
+	void setLiveness(const Liveness &liveness);
+
+	/**
+	 * Makes canonicalize() permute the threads of the given classes of interchangeable threads.
+	 */
+	void setSymmetry(const Symmetry &symmetry);
+
+	/**
+	 * \return True if there are interchangeable threads.
+	 */
+	bool isSymmetric() const { return !symmetryClasses_.empty(); }
+
+	/**
+	 * Permutes interchangeable threads so that their control states and registers
+	 * come in increasing order. The lock owner and the favourite are permuted too.
+	 * Symmetric states get the same canonical form.
+	 */
+	void canonicalize(SCState &state, SCUndoLog *log = NULL) const;
+
+	void print(const SCState &state, std::ostream &out) const;
+
+private:
+	template<class T>
+	static void write(SCState &state, std::size_t offset, T value, SCUndoLog *log) {
+		if (log && state.get<T>(offset) != value) {
+			log->recordWrite(state, offset, sizeof(T));
+		}
+		state.set<T>(offset, value);
+	}
+
+	struct OverflowCell {
+		Space space;
+		Address address;
+		Domain value;
+	};
+
+	static_assert(sizeof(OverflowCell) <= SCUndoLog::MAX_CHANGE_SIZE, "overflow cells must fit into undo log records");
+
+	OverflowCell getOverflowCell(const SCState &state, std::size_t offset) const;
+	std::size_t findOverflowCell(const SCState &state, Space space, Address address) const;
+};
+
+/**
+ * Transition of SCSemantics: the instruction executed and the resulting state.
+ *
+ * The source state is not stored: the one who enumerates the transitions knows it anyway.
+ */
 class SCTransition {
-	SCState source_;
 	SCState destination_;
 	const Instruction *instruction_;
+	uint64_t id_;
+
+	friend class SCSemantics;
 
 public:
-	SCTransition(SCState source, SCState destination, const Instruction *instruction):
-		source_(std::move(source)), destination_(std::move(destination)), instruction_(std::move(instruction))
-	{}
+	SCTransition(): instruction_(NULL), id_(0) {}
 
-	const SCState &source() const { return source_; }
 	const SCState &destination() const { return destination_; }
 	const Instruction *instruction() const { return instruction_; }
 };
 
+/**
+ * Position in the enumeration of the transitions going from a state.
+ */
+class SCTransitionCursor {
+	SCStateLayout::ThreadIndex thread_;
+	std::size_t transition_;
+
+	/** Thread whose transitions only are enumerated, or NO_THREAD if all threads are. */
+	SCStateLayout::ThreadIndex singleThread_;
+
+	/** Whether to enumerate all the threads if the single thread has no enabled transitions. */
+	bool fallBack_;
+
+	/** Whether any transition has been enumerated. */
+	bool found_;
+
+	/** Id of the last transition enumerated. */
+	uint64_t id_;
+
+	friend class SCSemantics;
+
+public:
+	SCTransitionCursor(): thread_(0), transition_(0), singleThread_(SCStateLayout::NO_THREAD), fallBack_(false), found_(false), id_(0) {}
+};
+
 std::ostream &operator<<(std::ostream &out, const SCTransition &transition);
 
 class SCSemantics {
 	const Program &program_;
-	Liveness liveness_;
+	bool partialOrderReduction_;
+	bool amplePartialOrderReduction_;
+	SCStateLayout layout_;
+	SCBytecode bytecode_;
+	Accesses accesses_;
+
+	struct ThreadTransition {
+		const Instruction *instruction;
+		SCStateLayout::StateIndex destination;
+		SCBytecode::Code code;
+		uint64_t id;
+	};
+
+	/** Outgoing transitions, indexed by thread id and state id. */
+	std::vector<std::vector<std::vector<ThreadTransition>>> transitions_;
 
 public:
 	typedef SCState State;
 	typedef SCTransition Transition;
+	typedef SCTransitionCursor TransitionCursor;
+	typedef SCUndoLog UndoLog;
 	typedef std::string Label;
 
-	SCSemantics(const Program &program);
+	/** Thread, its control state and the index of the transition going from it, packed together. */
+	typedef uint64_t TransitionId;
+
+	/**
+	 * \param program Program.
+	 * \param reduce  Whether to apply the reductions enabled in the configuration: the favourite
+	 *                thread, ample sets and symmetry. Searches doing their own partial order
+	 *                reduction need the plain semantics.
+	 */
+	explicit
+	SCSemantics(const Program &program, bool reduce = true);
+
+	const SCStateLayout &layout() const { return layout_; }
 
 	State initialState() const;
 
 	bool isFinal(const State &state) const {
-		return state.getMemoryValue(program_.interestingSpace(), program_.interestingAddress()) != 0;
+		return layout_.getMemoryValue(state, program_.interestingSpace(), program_.interestingAddress()) != 0;
 	}
 
-	const State &getName(const State &state) const { return state; }
+	std::string getName(const State &state) const;
+
+	/**
+	 * \return Lower bound on the number of transitions leading from the given state
+	 *         to a final state, or Accesses::INFINITE_DISTANCE if no final state is reachable.
+	 *         Needs the accesses, computed when the configuration asks for a guided search.
+	 */
+	std::size_t estimateDistanceToFinal(const State &state) const;
 
-	std::vector<Transition> getTransitionsFrom(const State &state) const;
+	/**
+	 * Starts enumerating the transitions going from the given state.
+	 *
+	 * \return Cursor pointing before the first transition.
+	 */
+	TransitionCursor getTransitionsFrom(const State &state) const;
+
+	/**
+	 * Starts enumerating the transitions of the given thread going from the given state.
+	 */
+	TransitionCursor getTransitionsFrom(const State &state, SCStateLayout::ThreadIndex thread) const;
+
+	std::size_t threadsCount() const { return layout_.threadsCount(); }
+
+	/**
+	 * Computes the next transition going from the given state.
+	 * Transitions are computed one at a time, so that the enumeration can be stopped early.
+	 *
+	 * \param[in]     state      Source state.
+	 * \param[in,out] cursor     Cursor returned by getTransitionsFrom() for the same state.
+	 * \param[out]    transition Where to put the transition.
+	 *
+	 * \return True if there was one more transition, false if the enumeration is over.
+	 */
+	bool getNextTransition(const State &state, TransitionCursor &cursor, Transition &transition) const;
+
+	/**
+	 * Like getNextTransition(), but changes the given state into the destination
+	 * of the transition in place, recording the changes into the undo log.
+	 *
+	 * The cursor must be the one for the state before the change: to get
+	 * the transition after this one, the caller must undo the change first.
+	 */
+	bool applyNextTransition(State &state, TransitionCursor &cursor, UndoLog &log) const;
 
-	const State &getSourceState(const Transition &transition) const { return transition.source(); }
 	const State &getDestinationState(const Transition &transition) const { return transition.destination(); }
 	const Transition &getLabel(const Transition &transition) const { return transition; }
+
+	TransitionId getTransitionId(const Transition &transition) const { return transition.id_; }
+
+	/**
+	 * \return Id of the transition last enumerated with the given cursor.
+	 */
+	TransitionId getTransitionId(const TransitionCursor &cursor) const { return cursor.id_; }
+
+	/**
+	 * \return Number of the transitions of the thread going from its control state
+	 *         in the given state, whether enabled or not.
+	 */
+	std::size_t getThreadTransitionsCount(const State &state, SCStateLayout::ThreadIndex thread) const {
+		return transitions_[thread][layout_.getControlStateIndex(state, thread)].size();
+	}
+
+	/**
+	 * \return Id of the transition with the given index among those counted by getThreadTransitionsCount().
+	 */
+	TransitionId getThreadTransitionId(const State &state, SCStateLayout::ThreadIndex thread, std::size_t index) const {
+		return transitions_[thread][layout_.getControlStateIndex(state, thread)][index].id;
+	}
+
+	/**
+	 * \return True if the two transitions, enabled in the same state, can be executed in any order
+	 *         leading to the same state and neither disables the other.
+	 *         The memory accesses of all the transitions of each thread from its control state
+	 *         are accounted for, so that an alternative enabled by the other transition is not missed.
+	 */
+	bool areIndependent(TransitionId a, TransitionId b) const;
+
+private:
+	/**
+	 * \return Thread whose transitions from the given state form an ample set,
+	 *         or NO_THREAD if there is none.
+	 */
+	SCStateLayout::ThreadIndex findAmpleThread(const State &state) const;
+
+	static TransitionId makeTransitionId(std::size_t thread, std::size_t state, std::size_t transition) {
+		assert(thread < (1 << 16) && state < (uint64_t(1) << 32) && transition < (1 << 16));
+		return (uint64_t(thread) << 48) | (uint64_t(state) << 16) | transition;
+	}
+
+	/**
+	 * Advances the cursor to the next transition for which the given functor,
+	 * called with the thread and the transition of the thread, returns true.
+	 */
+	template<class Try>
+	bool findNextTransition(const State &state, TransitionCursor &cursor, Try tryTransition) const;
 };
 
 } // namespace trench
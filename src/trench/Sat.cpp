@@ -0,0 +1,463 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#include "Sat.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace trench {
+
+namespace {
+
+const double VARIABLE_ACTIVITY_DECAY = 0.95;
+const double CLAUSE_ACTIVITY_DECAY = 0.999;
+const double MAX_ACTIVITY = 1e100;
+const std::size_t RESTART_UNIT = 100;
+const std::size_t MIN_LEARNTS = 2000;
+
+} // anonymous namespace
+
+const std::size_t SatSolver::NO_REASON;
+
+SatSolver::SatSolver():
+	ok_(true), propagated_(0), activityIncrement_(1), clauseActivityIncrement_(1), conflictsCount_(0)
+{}
+
+SatSolver::Variable SatSolver::newVariable() {
+	Variable variable = static_cast<Variable>(values_.size());
+	values_.push_back(UNDEFINED_VALUE);
+	levels_.push_back(0);
+	reasons_.push_back(NO_REASON);
+	phases_.push_back(false);
+	activities_.push_back(0);
+	heapIndices_.push_back(-1);
+	seen_.push_back(false);
+	watches_.resize(2 * values_.size());
+	heapInsert(variable);
+	return variable;
+}
+
+bool SatSolver::addClause(std::vector<Literal> literals) {
+	assert(decisionLevel() == 0);
+
+	if (!ok_) {
+		return false;
+	}
+
+	std::sort(literals.begin(), literals.end());
+	std::size_t size = 0;
+	for (std::size_t i = 0; i < literals.size(); ++i) {
+		Literal literal = literals[i];
+		if (getValue(literal) == TRUE_VALUE || (size > 0 && literals[size - 1] == negate(literal))) {
+			return true;
+		}
+		if (getValue(literal) == UNDEFINED_VALUE && (size == 0 || literals[size - 1] != literal)) {
+			literals[size++] = literal;
+		}
+	}
+	literals.resize(size);
+
+	if (literals.empty()) {
+		ok_ = false;
+	} else if (literals.size() == 1) {
+		assign(literals[0], NO_REASON);
+		ok_ = propagate() == NO_REASON;
+	} else {
+		attach(makeClause(literals, false));
+	}
+
+	return ok_;
+}
+
+void SatSolver::assign(Literal literal, std::size_t reason) {
+	auto variable = getVariable(literal);
+	values_[variable] = isNegated(literal) ? FALSE_VALUE : TRUE_VALUE;
+	levels_[variable] = decisionLevel();
+	reasons_[variable] = reason;
+	trail_.push_back(literal);
+}
+
+std::size_t SatSolver::makeClause(const std::vector<Literal> &literals, bool learnt) {
+	clauses_.push_back(Clause{literals_.size(), static_cast<uint32_t>(literals.size()), learnt, false, 0});
+	literals_.insert(literals_.end(), literals.begin(), literals.end());
+	return clauses_.size() - 1;
+}
+
+void SatSolver::attach(std::size_t clause) {
+	const Literal *literals = getLiterals(clause);
+	watches_[literals[0]].push_back(Watcher{clause, literals[1]});
+	watches_[literals[1]].push_back(Watcher{clause, literals[0]});
+}
+
+std::size_t SatSolver::propagate() {
+	while (propagated_ < trail_.size()) {
+		Literal falseLiteral = negate(trail_[propagated_++]);
+		auto &watchers = watches_[falseLiteral];
+
+		std::size_t i = 0;
+		std::size_t j = 0;
+		while (i < watchers.size()) {
+			Watcher watcher = watchers[i++];
+			if (getValue(watcher.blocker) == TRUE_VALUE) {
+				watchers[j++] = watcher;
+				continue;
+			}
+
+			const auto &clause = clauses_[watcher.clause];
+			if (clause.deleted) {
+				continue;
+			}
+
+			Literal *literals = &literals_[clause.begin];
+			if (literals[0] == falseLiteral) {
+				std::swap(literals[0], literals[1]);
+			}
+			Literal first = literals[0];
+			if (first != watcher.blocker && getValue(first) == TRUE_VALUE) {
+				watchers[j++] = Watcher{watcher.clause, first};
+				continue;
+			}
+
+			bool moved = false;
+			for (std::size_t k = 2; k < clause.size; ++k) {
+				if (getValue(literals[k]) != FALSE_VALUE) {
+					std::swap(literals[1], literals[k]);
+					watches_[literals[1]].push_back(Watcher{watcher.clause, first});
+					moved = true;
+					break;
+				}
+			}
+			if (moved) {
+				continue;
+			}
+
+			watchers[j++] = Watcher{watcher.clause, first};
+			if (getValue(first) == FALSE_VALUE) {
+				while (i < watchers.size()) {
+					watchers[j++] = watchers[i++];
+				}
+				watchers.resize(j);
+				propagated_ = trail_.size();
+				return watcher.clause;
+			}
+			assign(first, watcher.clause);
+		}
+		watchers.resize(j);
+	}
+	return NO_REASON;
+}
+
+void SatSolver::analyze(std::size_t conflict, std::vector<Literal> &learnt, int &backtrackLevel) {
+	learnt.clear();
+	learnt.push_back(0);
+
+	int pathsCount = 0;
+	Literal literal = -1;
+	std::size_t index = trail_.size();
+	std::size_t clause = conflict;
+
+	do {
+		if (clauses_[clause].learnt) {
+			bumpClause(clause);
+		}
+
+		const Literal *literals = getLiterals(clause);
+		for (std::size_t j = literal == -1 ? 0 : 1; j < clauses_[clause].size; ++j) {
+			auto variable = getVariable(literals[j]);
+			if (!seen_[variable] && levels_[variable] > 0) {
+				bumpVariable(variable);
+				seen_[variable] = true;
+				if (levels_[variable] >= decisionLevel()) {
+					++pathsCount;
+				} else {
+					learnt.push_back(literals[j]);
+				}
+			}
+		}
+
+		/* The next literal of the current level to resolve on. */
+		while (!seen_[getVariable(trail_[--index])]) {}
+		literal = trail_[index];
+		clause = reasons_[getVariable(literal)];
+		seen_[getVariable(literal)] = false;
+		--pathsCount;
+	} while (pathsCount > 0);
+
+	learnt[0] = negate(literal);
+
+	std::vector<Literal> analyzed(learnt);
+	std::size_t size = 1;
+	for (std::size_t i = 1; i < learnt.size(); ++i) {
+		if (!isRedundant(learnt[i])) {
+			learnt[size++] = learnt[i];
+		}
+	}
+	learnt.resize(size);
+
+	for (Literal l : analyzed) {
+		seen_[getVariable(l)] = false;
+	}
+
+	backtrackLevel = 0;
+	if (learnt.size() > 1) {
+		std::size_t max = 1;
+		for (std::size_t i = 2; i < learnt.size(); ++i) {
+			if (levels_[getVariable(learnt[i])] > levels_[getVariable(learnt[max])]) {
+				max = i;
+			}
+		}
+		std::swap(learnt[1], learnt[max]);
+		backtrackLevel = levels_[getVariable(learnt[1])];
+	}
+}
+
+bool SatSolver::isRedundant(Literal literal) const {
+	auto reason = reasons_[getVariable(literal)];
+	if (reason == NO_REASON) {
+		return false;
+	}
+	const Literal *literals = getLiterals(reason);
+	for (std::size_t i = 1; i < clauses_[reason].size; ++i) {
+		auto variable = getVariable(literals[i]);
+		if (!seen_[variable] && levels_[variable] > 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void SatSolver::backtrack(int level) {
+	if (decisionLevel() <= level) {
+		return;
+	}
+	for (std::size_t i = trail_.size(); i-- > trailLimits_[level]; ) {
+		auto variable = getVariable(trail_[i]);
+		phases_[variable] = !isNegated(trail_[i]);
+		values_[variable] = UNDEFINED_VALUE;
+		reasons_[variable] = NO_REASON;
+		if (heapIndices_[variable] < 0) {
+			heapInsert(variable);
+		}
+	}
+	trail_.resize(trailLimits_[level]);
+	trailLimits_.resize(level);
+	propagated_ = trail_.size();
+}
+
+bool SatSolver::isLocked(std::size_t clause) const {
+	Literal first = getLiterals(clause)[0];
+	return getValue(first) == TRUE_VALUE && reasons_[getVariable(first)] == clause;
+}
+
+void SatSolver::reduceLearnts() {
+	std::sort(learnts_.begin(), learnts_.end(), [this](std::size_t a, std::size_t b) {
+		return clauses_[a].activity < clauses_[b].activity;
+	});
+
+	std::vector<std::size_t> kept;
+	for (std::size_t i = 0; i < learnts_.size(); ++i) {
+		auto &clause = clauses_[learnts_[i]];
+		if (i < learnts_.size() / 2 && clause.size > 2 && !isLocked(learnts_[i])) {
+			/* Watchers of the clause are dropped when visited. */
+			clause.deleted = true;
+		} else {
+			kept.push_back(learnts_[i]);
+		}
+	}
+	learnts_.swap(kept);
+}
+
+void SatSolver::bumpVariable(Variable variable) {
+	activities_[variable] += activityIncrement_;
+	if (activities_[variable] > MAX_ACTIVITY) {
+		for (auto &activity : activities_) {
+			activity /= MAX_ACTIVITY;
+		}
+		activityIncrement_ /= MAX_ACTIVITY;
+	}
+	if (heapIndices_[variable] >= 0) {
+		heapUp(heapIndices_[variable]);
+	}
+}
+
+void SatSolver::bumpClause(std::size_t clause) {
+	clauses_[clause].activity += clauseActivityIncrement_;
+	if (clauses_[clause].activity > MAX_ACTIVITY) {
+		for (auto learnt : learnts_) {
+			clauses_[learnt].activity /= MAX_ACTIVITY;
+		}
+		clauseActivityIncrement_ /= MAX_ACTIVITY;
+	}
+}
+
+void SatSolver::heapInsert(Variable variable) {
+	heapIndices_[variable] = static_cast<int>(heap_.size());
+	heap_.push_back(variable);
+	heapUp(heap_.size() - 1);
+}
+
+SatSolver::Variable SatSolver::heapPop() {
+	Variable result = heap_.front();
+	heapIndices_[result] = -1;
+	heap_.front() = heap_.back();
+	heap_.pop_back();
+	if (!heap_.empty()) {
+		heapIndices_[heap_.front()] = 0;
+		heapDown(0);
+	}
+	return result;
+}
+
+void SatSolver::heapUp(std::size_t index) {
+	Variable variable = heap_[index];
+	while (index > 0 && heapLess(variable, heap_[(index - 1) / 2])) {
+		heap_[index] = heap_[(index - 1) / 2];
+		heapIndices_[heap_[index]] = static_cast<int>(index);
+		index = (index - 1) / 2;
+	}
+	heap_[index] = variable;
+	heapIndices_[variable] = static_cast<int>(index);
+}
+
+void SatSolver::heapDown(std::size_t index) {
+	Variable variable = heap_[index];
+	while (2 * index + 1 < heap_.size()) {
+		std::size_t child = 2 * index + 1;
+		if (child + 1 < heap_.size() && heapLess(heap_[child + 1], heap_[child])) {
+			++child;
+		}
+		if (!heapLess(heap_[child], variable)) {
+			break;
+		}
+		heap_[index] = heap_[child];
+		heapIndices_[heap_[index]] = static_cast<int>(index);
+		index = child;
+	}
+	heap_[index] = variable;
+	heapIndices_[variable] = static_cast<int>(index);
+}
+
+double SatSolver::luby(std::size_t index) {
+	/* Finds the finite subsequence containing the index and its size. */
+	std::size_t size = 1;
+	std::size_t sequence = 0;
+	while (size < index + 1) {
+		++sequence;
+		size = 2 * size + 1;
+	}
+	while (size - 1 != index) {
+		size = (size - 1) / 2;
+		--sequence;
+		index = index % size;
+	}
+	return static_cast<double>(std::size_t(1) << sequence);
+}
+
+SatSolver::Result SatSolver::solve(const std::vector<Literal> &assumptions, std::size_t maxConflicts) {
+	assert(decisionLevel() == 0);
+
+	if (!ok_) {
+		return UNSATISFIABLE;
+	}
+
+	std::size_t conflicts = 0;
+	std::size_t restarts = 0;
+	std::size_t restartConflicts = 0;
+	std::size_t restartLimit = static_cast<std::size_t>(luby(0) * RESTART_UNIT);
+	std::size_t maxLearnts = std::max(MIN_LEARNTS, (clauses_.size() - learnts_.size()) / 3);
+
+	std::vector<Literal> learnt;
+
+	while (true) {
+		auto conflict = propagate();
+		if (conflict != NO_REASON) {
+			++conflicts;
+			++conflictsCount_;
+			++restartConflicts;
+
+			if (decisionLevel() == 0) {
+				ok_ = false;
+				return UNSATISFIABLE;
+			}
+
+			int backtrackLevel;
+			analyze(conflict, learnt, backtrackLevel);
+			backtrack(backtrackLevel);
+
+			if (learnt.size() == 1) {
+				assign(learnt[0], NO_REASON);
+			} else {
+				auto clause = makeClause(learnt, true);
+				learnts_.push_back(clause);
+				attach(clause);
+				bumpClause(clause);
+				assign(learnt[0], clause);
+			}
+
+			activityIncrement_ /= VARIABLE_ACTIVITY_DECAY;
+			clauseActivityIncrement_ /= CLAUSE_ACTIVITY_DECAY;
+			continue;
+		}
+
+		if (maxConflicts > 0 && conflicts >= maxConflicts) {
+			backtrack(0);
+			return UNKNOWN;
+		}
+
+		if (restartConflicts >= restartLimit) {
+			backtrack(0);
+			restartConflicts = 0;
+			restartLimit = static_cast<std::size_t>(luby(++restarts) * RESTART_UNIT);
+		}
+
+		if (learnts_.size() >= maxLearnts + trail_.size()) {
+			reduceLearnts();
+			maxLearnts += maxLearnts / 10;
+		}
+
+		Literal decision = -1;
+		while (decisionLevel() < static_cast<int>(assumptions.size())) {
+			Literal assumption = assumptions[decisionLevel()];
+			Value value = getValue(assumption);
+			if (value == TRUE_VALUE) {
+				/* A dummy level, so that levels and assumptions stay in correspondence. */
+				trailLimits_.push_back(trail_.size());
+			} else if (value == FALSE_VALUE) {
+				backtrack(0);
+				return UNSATISFIABLE;
+			} else {
+				decision = assumption;
+				break;
+			}
+		}
+
+		if (decision == -1) {
+			Variable variable = -1;
+			while (!heap_.empty()) {
+				variable = heapPop();
+				if (values_[variable] == UNDEFINED_VALUE) {
+					break;
+				}
+				variable = -1;
+			}
+			if (variable == -1) {
+				model_ = values_;
+				backtrack(0);
+				return SATISFIABLE;
+			}
+			decision = makeLiteral(variable, !phases_[variable]);
+		}
+
+		trailLimits_.push_back(trail_.size());
+		assign(decision, NO_REASON);
+	}
+}
+
+} // namespace trench
@@ -0,0 +1,159 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <trench/config.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace trench {
+
+/**
+ * Incremental CDCL SAT solver.
+ *
+ * The solver propagates with two watched literals, learns first-UIP clauses,
+ * picks variables by their activity in recent conflicts (VSIDS), saves phases,
+ * restarts following the Luby sequence, and forgets inactive learnt clauses.
+ * Clauses can be added between calls to solve(), and each call can assume
+ * some literals to be true.
+ */
+class SatSolver {
+public:
+	typedef int Variable;
+
+	/** Literal of a variable v: 2v if positive, 2v + 1 if negated. */
+	typedef int Literal;
+
+	enum Result {
+		SATISFIABLE,
+		UNSATISFIABLE,
+		/** The solver has given up. */
+		UNKNOWN
+	};
+
+	static Literal makeLiteral(Variable variable, bool negated = false) { return 2 * variable + (negated ? 1 : 0); }
+	static Literal negate(Literal literal) { return literal ^ 1; }
+	static Variable getVariable(Literal literal) { return literal >> 1; }
+	static bool isNegated(Literal literal) { return literal & 1; }
+
+private:
+	enum Value : int8_t { FALSE_VALUE = -1, UNDEFINED_VALUE = 0, TRUE_VALUE = 1 };
+
+	static const std::size_t NO_REASON = static_cast<std::size_t>(-1);
+
+	/** Clause, its literals being stored contiguously in the arena of literals. */
+	struct Clause {
+		std::size_t begin;
+		uint32_t size;
+		bool learnt;
+		bool deleted;
+		double activity;
+	};
+
+	struct Watcher {
+		std::size_t clause;
+		/** Literal of the clause; if it is true, the clause need not be visited. */
+		Literal blocker;
+	};
+
+	bool ok_;
+
+	std::vector<Clause> clauses_;
+	std::vector<Literal> literals_;
+	std::vector<std::size_t> learnts_;
+	std::vector<std::vector<Watcher>> watches_;
+
+	std::vector<Value> values_;
+	std::vector<int> levels_;
+	std::vector<std::size_t> reasons_;
+	std::vector<bool> phases_;
+	std::vector<Value> model_;
+
+	std::vector<Literal> trail_;
+	std::vector<std::size_t> trailLimits_;
+	std::size_t propagated_;
+
+	std::vector<double> activities_;
+	double activityIncrement_;
+	double clauseActivityIncrement_;
+	std::vector<Variable> heap_;
+	std::vector<int> heapIndices_;
+
+	std::vector<bool> seen_;
+
+	std::size_t conflictsCount_;
+
+public:
+	SatSolver();
+
+	Variable newVariable();
+	std::size_t variablesCount() const { return values_.size(); }
+
+	/**
+	 * Adds a clause. Must not be called during solve().
+	 *
+	 * \return False if the clauses have become unsatisfiable, true otherwise.
+	 */
+	bool addClause(std::vector<Literal> literals);
+
+	/**
+	 * Checks whether the clauses are satisfiable, with the given literals being true.
+	 *
+	 * \param assumptions  Literals assumed to be true.
+	 * \param maxConflicts Number of conflicts after which the solver gives up, zero if unlimited.
+	 */
+	Result solve(const std::vector<Literal> &assumptions, std::size_t maxConflicts = 0);
+
+	/**
+	 * \return Value of the literal in the model found by the last successful call to solve().
+	 */
+	bool getModelValue(Literal literal) const {
+		return (model_[getVariable(literal)] == TRUE_VALUE) != isNegated(literal);
+	}
+
+	/** Number of conflicts in all the calls to solve(). */
+	std::size_t conflictsCount() const { return conflictsCount_; }
+
+private:
+	Value getValue(Literal literal) const {
+		Value value = values_[getVariable(literal)];
+		return isNegated(literal) ? static_cast<Value>(-value) : value;
+	}
+
+	int decisionLevel() const { return static_cast<int>(trailLimits_.size()); }
+
+	Literal *getLiterals(std::size_t clause) { return &literals_[clauses_[clause].begin]; }
+	const Literal *getLiterals(std::size_t clause) const { return &literals_[clauses_[clause].begin]; }
+
+	void assign(Literal literal, std::size_t reason);
+	std::size_t makeClause(const std::vector<Literal> &literals, bool learnt);
+	void attach(std::size_t clause);
+	std::size_t propagate();
+	void analyze(std::size_t conflict, std::vector<Literal> &learnt, int &backtrackLevel);
+	bool isRedundant(Literal literal) const;
+	void backtrack(int level);
+	void reduceLearnts();
+	bool isLocked(std::size_t clause) const;
+
+	void bumpVariable(Variable variable);
+	void bumpClause(std::size_t clause);
+
+	bool heapLess(Variable a, Variable b) const { return activities_[a] > activities_[b]; }
+	void heapInsert(Variable variable);
+	Variable heapPop();
+	void heapUp(std::size_t index);
+	void heapDown(std::size_t index);
+
+	static double luby(std::size_t index);
+};
+
+} // namespace trench
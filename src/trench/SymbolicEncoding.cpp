@@ -0,0 +1,123 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#include "SymbolicEncoding.h"
+
+#include <algorithm>
+
+#include <boost/unordered_set.hpp>
+
+#include "Program.h"
+
+namespace trench {
+
+SymbolicLayout::SymbolicLayout(const Program &program, unsigned width):
+	width_(width)
+{
+	assert(width > 0);
+
+	census_.visit(program);
+	census_.addCell(program.interestingSpace(), program.interestingAddress());
+
+	std::size_t offset = 0;
+
+	for (std::size_t thread = 0; thread < census_.threads().size(); ++thread) {
+		controlStateOffsets_.push_back(offset);
+		controlStateWidths_.push_back(getWidth(census_.states(thread).size()));
+		offset += controlStateWidths_.back();
+	}
+
+	lockOwnerOffset_ = offset;
+	lockOwnerWidth_ = getWidth(census_.threads().size() + 1);
+	offset += lockOwnerWidth_;
+
+	cells_ = census_.cells();
+
+	boost::unordered_set<Space> dynamicSpaces;
+	std::vector<Address> addresses;
+	for (const Instruction *instruction : census_.instructions()) {
+		Space space;
+		const Expression *address;
+		if (auto read = instruction->as<Read>()) {
+			space = read->space();
+			address = read->address().get();
+		} else if (auto write = instruction->as<Write>()) {
+			space = write->space();
+			address = write->address().get();
+		} else {
+			continue;
+		}
+		if (auto constant = address->as<Constant>()) {
+			addresses.push_back(constant->value());
+		} else {
+			dynamicSpaces.insert(space);
+		}
+	}
+	std::sort(addresses.begin(), addresses.end());
+	addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+
+	for (std::size_t cell = 0; cell < cells_.size(); ++cell) {
+		cell2index_[cells_[cell]] = cell;
+	}
+	for (Space space : census_.spaces()) {
+		if (dynamicSpaces.find(space) != dynamicSpaces.end()) {
+			for (Address address : addresses) {
+				if (cell2index_.find(std::make_pair(space, address)) == cell2index_.end()) {
+					cell2index_[std::make_pair(space, address)] = cells_.size();
+					cells_.push_back(std::make_pair(space, address));
+				}
+			}
+		}
+	}
+
+	for (std::size_t cell = 0; cell < cells_.size(); ++cell) {
+		spaceCells_[cells_[cell].first].push_back(cell);
+		cellOffsets_.push_back(offset);
+		offset += width_;
+	}
+	interestingCell_ = getCell(program.interestingSpace(), program.interestingAddress());
+
+	registerOffsets_.resize(census_.threads().size());
+	for (std::size_t thread = 0; thread < census_.threads().size(); ++thread) {
+		for (std::size_t reg : census_.registers(thread)) {
+			registerOffsets_[thread][reg] = offset;
+			offset += width_;
+		}
+	}
+
+	size_ = offset;
+}
+
+std::size_t SymbolicLayout::getCell(Space space, Address address) const {
+	auto i = cell2index_.find(std::make_pair(space, address));
+	return i != cell2index_.end() ? i->second : Census::NO_ID;
+}
+
+const std::vector<std::size_t> &SymbolicLayout::getCells(Space space) const {
+	static const std::vector<std::size_t> empty;
+
+	auto i = spaceCells_.find(space);
+	return i != spaceCells_.end() ? i->second : empty;
+}
+
+std::size_t SymbolicLayout::getRegisterOffset(std::size_t thread, std::size_t reg) const {
+	auto i = registerOffsets_[thread].find(reg);
+	assert(i != registerOffsets_[thread].end());
+	return i->second;
+}
+
+unsigned SymbolicLayout::getWidth(std::size_t count) {
+	unsigned result = 0;
+	while ((std::size_t(1) << result) < count) {
+		++result;
+	}
+	return result;
+}
+
+} // namespace trench
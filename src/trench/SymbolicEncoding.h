@@ -0,0 +1,488 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <trench/config.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+#include "Census.h"
+#include "Expression.h"
+#include "Instruction.h"
+#include "Transition.h"
+
+namespace trench {
+
+class Program;
+
+/**
+ * Describes which bits encode the components of a program's SC states.
+ *
+ * Control states, the owner of the memory lock (plus one, zero if nobody owns it),
+ * memory cells and registers of each thread are bit-vectors, least significant bit
+ * first, in this order. Values of cells and registers have the given width and are
+ * signed.
+ * The initial state is encoded by all bits being zero.
+ *
+ * Cells are those with constant addresses in the program. In each space accessed
+ * at an address only known at run time, there is also a cell for every constant
+ * address accessed in any space.
+ */
+class SymbolicLayout {
+	Census census_;
+	unsigned width_;
+
+	std::vector<std::size_t> controlStateOffsets_;
+	std::vector<unsigned> controlStateWidths_;
+	std::size_t lockOwnerOffset_;
+	unsigned lockOwnerWidth_;
+
+	std::vector<std::pair<Space, Address>> cells_;
+	boost::unordered_map<std::pair<Space, Address>, std::size_t> cell2index_;
+	boost::unordered_map<Space, std::vector<std::size_t>> spaceCells_;
+	std::vector<std::size_t> cellOffsets_;
+	std::size_t interestingCell_;
+
+	std::vector<boost::unordered_map<std::size_t, std::size_t>> registerOffsets_;
+
+	std::size_t size_;
+
+public:
+	/**
+	 * \param program Program.
+	 * \param width   Number of bits in the values of cells and registers.
+	 */
+	SymbolicLayout(const Program &program, unsigned width);
+
+	const Census &census() const { return census_; }
+	unsigned width() const { return width_; }
+
+	/** Number of bits encoding a state. */
+	std::size_t size() const { return size_; }
+
+	std::size_t getControlStateOffset(std::size_t thread) const { return controlStateOffsets_[thread]; }
+	unsigned getControlStateWidth(std::size_t thread) const { return controlStateWidths_[thread]; }
+
+	std::size_t lockOwnerOffset() const { return lockOwnerOffset_; }
+	unsigned lockOwnerWidth() const { return lockOwnerWidth_; }
+
+	/** Offset of the first bit of the values of cells and registers. */
+	std::size_t valuesOffset() const { return lockOwnerOffset_ + lockOwnerWidth_; }
+
+	const std::vector<std::pair<Space, Address>> &cells() const { return cells_; }
+	std::size_t getCellOffset(std::size_t cell) const { return cellOffsets_[cell]; }
+
+	/**
+	 * \return Index of the cell with the given address, Census::NO_ID if there is none.
+	 */
+	std::size_t getCell(Space space, Address address) const;
+
+	/**
+	 * \return Indices of the cells of the given space.
+	 */
+	const std::vector<std::size_t> &getCells(Space space) const;
+
+	/** Index of the interesting cell. */
+	std::size_t interestingCell() const { return interestingCell_; }
+
+	std::size_t getRegisterOffset(std::size_t thread, std::size_t reg) const;
+
+	/**
+	 * \return Number of bits needed to encode numbers from 0 to count - 1.
+	 */
+	static unsigned getWidth(std::size_t count);
+};
+
+/**
+ * Encodes the execution of transitions of a program as Boolean functions of the bits
+ * of the state before it.
+ *
+ * The encoding is parametrized by a Boolean algebra, providing the type Bit of its
+ * elements, zero(), one(), bitNot(), bitAnd(), bitOr(), bitXor() and bitIte().
+ * Arithmetic is done modulo two to the power of the width. Whenever this can differ
+ * from the exact arithmetic, or the execution writes a memory cell the layout does
+ * not have, the execution is said to escape the encoding.
+ */
+template<class Algebra>
+class SymbolicExecutor {
+public:
+	typedef typename Algebra::Bit Bit;
+	typedef std::vector<Bit> Bits;
+
+private:
+	const SymbolicLayout &layout_;
+	Algebra &algebra_;
+	bool exact_;
+
+public:
+	SymbolicExecutor(const SymbolicLayout &layout, Algebra &algebra):
+		layout_(layout), algebra_(algebra), exact_(true)
+	{}
+
+	/**
+	 * \return False if some constant encoded so far does not fit into the width, true otherwise.
+	 */
+	bool isExact() const { return exact_; }
+
+	Bits initialState() const { return Bits(layout_.size(), algebra_.zero()); }
+
+	/**
+	 * \return Bit which is true iff the interesting memory cell is nonzero.
+	 */
+	Bit isFinal(const Bits &state) {
+		auto cell = layout_.interestingCell();
+		return isNonzero(field(state, layout_.getCellOffset(cell), layout_.width()));
+	}
+
+	/**
+	 * Encodes the execution of a transition.
+	 *
+	 * \param[in]  thread     Index of the thread executing the transition.
+	 * \param[in]  transition Transition.
+	 * \param[in]  state      Bits of the state before the execution.
+	 * \param[out] next       Bits of the state after it. The bits the transition does
+	 *                        not change are copied from state.
+	 * \param[out] escape     Bit which is true iff the execution escapes the encoding.
+	 *
+	 * \return Bit which is true iff the transition is executable.
+	 */
+	Bit execute(std::size_t thread, const Transition &transition, const Bits &state, Bits &next, Bit &escape) {
+		const auto &census = layout_.census();
+		auto offset = layout_.getControlStateOffset(thread);
+		auto width = layout_.getControlStateWidth(thread);
+
+		next = state;
+		escape = algebra_.zero();
+
+		Bit guard = equal(field(state, offset, width), constant(census.getId(transition.from()), width));
+		assign(next, offset, constant(census.getId(transition.to()), width));
+		executeInstruction(*transition.instruction(), thread, next, guard, escape);
+
+		return guard;
+	}
+
+private:
+	typedef std::vector<Bit> Word;
+
+	static Word field(const Bits &state, std::size_t offset, unsigned width) {
+		return Word(state.begin() + offset, state.begin() + offset + width);
+	}
+
+	static void assign(Bits &state, std::size_t offset, const Word &word) {
+		std::copy(word.begin(), word.end(), state.begin() + offset);
+	}
+
+	Word constant(long long value, unsigned width) {
+		Word result(width);
+		for (unsigned i = 0; i < width; ++i) {
+			result[i] = (value >> i) & 1 ? algebra_.one() : algebra_.zero();
+		}
+		return result;
+	}
+
+	/**
+	 * \return Whether the value can be represented by a word of the width of values.
+	 */
+	bool fits(long long value) const {
+		auto width = layout_.width();
+		return -(1LL << (width - 1)) <= value && value < (1LL << (width - 1));
+	}
+
+	Word fromBit(Bit bit) {
+		Word result = constant(0, layout_.width());
+		result[0] = bit;
+		return result;
+	}
+
+	Bit isNonzero(const Word &word) {
+		Bit result = algebra_.zero();
+		for (const auto &bit : word) {
+			result = algebra_.bitOr(result, bit);
+		}
+		return result;
+	}
+
+	Bit equal(const Word &a, const Word &b) {
+		Bit result = algebra_.one();
+		for (std::size_t i = 0; i < a.size(); ++i) {
+			result = algebra_.bitAnd(result, algebra_.bitNot(algebra_.bitXor(a[i], b[i])));
+		}
+		return result;
+	}
+
+	/**
+	 * \return Bit which is true iff a is less than b, both being signed.
+	 */
+	Bit lessThan(const Word &a, const Word &b) {
+		Bit result = algebra_.zero();
+		for (std::size_t i = 0; i < a.size(); ++i) {
+			Bit x = a[i];
+			Bit y = b[i];
+			if (i + 1 == a.size()) {
+				/* The sign bit orders the other way round. */
+				std::swap(x, y);
+			}
+			result = algebra_.bitIte(algebra_.bitXor(x, y), y, result);
+		}
+		return result;
+	}
+
+	Word add(const Word &a, const Word &b, Bit carry) {
+		Word result(a.size());
+		for (std::size_t i = 0; i < a.size(); ++i) {
+			Bit sum = algebra_.bitXor(a[i], b[i]);
+			result[i] = algebra_.bitXor(sum, carry);
+			carry = algebra_.bitOr(algebra_.bitAnd(a[i], b[i]), algebra_.bitAnd(sum, carry));
+		}
+		return result;
+	}
+
+	Word negate(const Word &a) {
+		Word result(a.size());
+		for (std::size_t i = 0; i < a.size(); ++i) {
+			result[i] = algebra_.bitNot(a[i]);
+		}
+		return result;
+	}
+
+	/**
+	 * \return Bit which is true iff adding a and b overflows, given their sum.
+	 */
+	Bit addOverflows(const Word &a, const Word &b, const Word &sum) {
+		Bit sameSigns = algebra_.bitNot(algebra_.bitXor(a.back(), b.back()));
+		return algebra_.bitAnd(sameSigns, algebra_.bitXor(sum.back(), a.back()));
+	}
+
+	/**
+	 * \return Product of a and b, computed in twice the width of a.
+	 */
+	Word multiply(const Word &a, const Word &b) {
+		auto width = a.size();
+		Word x(a);
+		Word y(b);
+		x.resize(2 * width, a.back());
+		y.resize(2 * width, b.back());
+
+		Word result = constant(0, 2 * width);
+		for (std::size_t i = 0; i < 2 * width; ++i) {
+			Word addend(2 * width, algebra_.zero());
+			for (std::size_t j = i; j < 2 * width; ++j) {
+				addend[j] = algebra_.bitAnd(x[j - i], y[i]);
+			}
+			result = add(result, addend, algebra_.zero());
+		}
+		return result;
+	}
+
+	void escapeIf(Bit condition, Bit guard, Bit &escape) {
+		escape = algebra_.bitOr(escape, algebra_.bitAnd(guard, condition));
+	}
+
+	Word evaluate(const Expression &expression, std::size_t thread, const Bits &state, Bit guard, Bit &escape) {
+		auto width = layout_.width();
+
+		switch (expression.kind()) {
+			case Expression::CONSTANT: {
+				auto value = expression.as<Constant>()->value();
+				if (!fits(value)) {
+					exact_ = false;
+				}
+				return constant(value, width);
+			}
+			case Expression::REGISTER: {
+				auto reg = layout_.census().getId(expression.as<Register>());
+				return field(state, layout_.getRegisterOffset(thread, reg), width);
+			}
+			case Expression::UNARY: {
+				auto unary = expression.as<UnaryOperator>();
+				auto operand = evaluate(*unary->operand(), thread, state, guard, escape);
+				switch (unary->kind()) {
+					case UnaryOperator::NOT:
+						return fromBit(algebra_.bitNot(isNonzero(operand)));
+				}
+				assert(!"NEVER REACHED");
+				return operand;
+			}
+			case Expression::BINARY: {
+				auto binary = expression.as<BinaryOperator>();
+				auto left = evaluate(*binary->left(), thread, state, guard, escape);
+				auto right = evaluate(*binary->right(), thread, state, guard, escape);
+				switch (binary->kind()) {
+					case BinaryOperator::EQ:
+						return fromBit(equal(left, right));
+					case BinaryOperator::NEQ:
+						return fromBit(algebra_.bitNot(equal(left, right)));
+					case BinaryOperator::LT:
+						return fromBit(lessThan(left, right));
+					case BinaryOperator::LEQ:
+						return fromBit(algebra_.bitNot(lessThan(right, left)));
+					case BinaryOperator::GT:
+						return fromBit(lessThan(right, left));
+					case BinaryOperator::GEQ:
+						return fromBit(algebra_.bitNot(lessThan(left, right)));
+					case BinaryOperator::AND:
+						return fromBit(algebra_.bitAnd(isNonzero(left), isNonzero(right)));
+					case BinaryOperator::OR:
+						return fromBit(algebra_.bitOr(isNonzero(left), isNonzero(right)));
+					case BinaryOperator::ADD: {
+						auto result = add(left, right, algebra_.zero());
+						escapeIf(addOverflows(left, right, result), guard, escape);
+						return result;
+					}
+					case BinaryOperator::SUB: {
+						auto negated = negate(right);
+						auto result = add(left, negated, algebra_.one());
+						Bit differentSigns = algebra_.bitXor(left.back(), right.back());
+						escapeIf(algebra_.bitAnd(differentSigns, algebra_.bitXor(result.back(), left.back())), guard, escape);
+						return result;
+					}
+					case BinaryOperator::MUL: {
+						auto product = multiply(left, right);
+						Bit overflow = algebra_.zero();
+						for (std::size_t i = width; i < product.size(); ++i) {
+							overflow = algebra_.bitOr(overflow, algebra_.bitXor(product[i], product[width - 1]));
+						}
+						escapeIf(overflow, guard, escape);
+						product.resize(width);
+						return product;
+					}
+					case BinaryOperator::BIN_AND: {
+						Word result(width);
+						for (unsigned i = 0; i < width; ++i) {
+							result[i] = algebra_.bitAnd(left[i], right[i]);
+						}
+						return result;
+					}
+				}
+				assert(!"NEVER REACHED");
+				return left;
+			}
+			case Expression::CAN_ACCESS_MEMORY: {
+				auto owner = field(state, layout_.lockOwnerOffset(), layout_.lockOwnerWidth());
+				return fromBit(algebra_.bitOr(
+					equal(owner, constant(0, layout_.lockOwnerWidth())),
+					equal(owner, constant(thread + 1, layout_.lockOwnerWidth()))));
+			}
+		}
+		assert(!"NEVER REACHED");
+		return Word();
+	}
+
+	/**
+	 * \return Bits which are true iff the address equals the address of the respective cell of the space.
+	 */
+	std::vector<Bit> match(const Word &address, Space space) {
+		std::vector<Bit> result;
+		for (auto cell : layout_.getCells(space)) {
+			auto cellAddress = layout_.cells()[cell].second;
+			result.push_back(fits(cellAddress) ? equal(address, constant(cellAddress, layout_.width())) : algebra_.zero());
+		}
+		return result;
+	}
+
+	void executeInstruction(const Instruction &instruction, std::size_t thread, Bits &state, Bit &guard, Bit &escape) {
+		const auto &census = layout_.census();
+		auto width = layout_.width();
+
+		switch (instruction.mnemonic()) {
+			case Instruction::READ: {
+				auto read = instruction.as<Read>();
+				Word value;
+				auto constantAddress = read->address()->as<Constant>();
+				if (constantAddress) {
+					auto cell = layout_.getCell(read->space(), constantAddress->value());
+					value = field(state, layout_.getCellOffset(cell), width);
+				} else {
+					/* Cells the layout does not have are never written, so they are zero. */
+					auto address = evaluate(*read->address(), thread, state, guard, escape);
+					auto matches = match(address, read->space());
+					value = constant(0, width);
+					const auto &cells = layout_.getCells(read->space());
+					for (std::size_t i = 0; i < cells.size(); ++i) {
+						auto cellValue = field(state, layout_.getCellOffset(cells[i]), width);
+						for (unsigned j = 0; j < width; ++j) {
+							value[j] = algebra_.bitOr(value[j], algebra_.bitAnd(matches[i], cellValue[j]));
+						}
+					}
+				}
+				assign(state, layout_.getRegisterOffset(thread, census.getId(read->reg().get())), value);
+				return;
+			}
+			case Instruction::WRITE: {
+				auto write = instruction.as<Write>();
+				auto value = evaluate(*write->value(), thread, state, guard, escape);
+				auto constantAddress = write->address()->as<Constant>();
+				if (constantAddress) {
+					auto cell = layout_.getCell(write->space(), constantAddress->value());
+					assign(state, layout_.getCellOffset(cell), value);
+				} else {
+					auto address = evaluate(*write->address(), thread, state, guard, escape);
+					auto matches = match(address, write->space());
+					Bit matched = algebra_.zero();
+					const auto &cells = layout_.getCells(write->space());
+					for (std::size_t i = 0; i < cells.size(); ++i) {
+						auto offset = layout_.getCellOffset(cells[i]);
+						auto cellValue = field(state, offset, width);
+						for (unsigned j = 0; j < width; ++j) {
+							cellValue[j] = algebra_.bitIte(matches[i], value[j], cellValue[j]);
+						}
+						assign(state, offset, cellValue);
+						matched = algebra_.bitOr(matched, matches[i]);
+					}
+					escapeIf(algebra_.bitNot(matched), guard, escape);
+				}
+				return;
+			}
+			case Instruction::MFENCE: /* FALLTHROUGH */
+			case Instruction::NOOP: {
+				return;
+			}
+			case Instruction::LOCAL: {
+				auto local = instruction.as<Local>();
+				auto value = evaluate(*local->value(), thread, state, guard, escape);
+				assign(state, layout_.getRegisterOffset(thread, census.getId(local->reg().get())), value);
+				return;
+			}
+			case Instruction::CONDITION: {
+				auto condition = instruction.as<Condition>();
+				auto value = evaluate(*condition->expression(), thread, state, guard, escape);
+				guard = algebra_.bitAnd(guard, isNonzero(value));
+				return;
+			}
+			case Instruction::ATOMIC: {
+				for (const auto &instr : instruction.as<Atomic>()->instructions()) {
+					executeInstruction(*instr, thread, state, guard, escape);
+				}
+				return;
+			}
+			case Instruction::LOCK: {
+				auto owner = field(state, layout_.lockOwnerOffset(), layout_.lockOwnerWidth());
+				guard = algebra_.bitAnd(guard, equal(owner, constant(0, layout_.lockOwnerWidth())));
+				assign(state, layout_.lockOwnerOffset(), constant(thread + 1, layout_.lockOwnerWidth()));
+				return;
+			}
+			case Instruction::UNLOCK: {
+				auto owner = field(state, layout_.lockOwnerOffset(), layout_.lockOwnerWidth());
+				guard = algebra_.bitAnd(guard, equal(owner, constant(thread + 1, layout_.lockOwnerWidth())));
+				assign(state, layout_.lockOwnerOffset(), constant(0, layout_.lockOwnerWidth()));
+				return;
+			}
+		}
+		assert(!"NEVER REACHED");
+	}
+};
+
+} // namespace trench
@@ -0,0 +1,197 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#include "SymbolicReachability.h"
+
+#include <vector>
+
+#include "Bdd.h"
+#include "Benchmarking.h"
+#include "SymbolicEncoding.h"
+#include "Thread.h"
+
+namespace trench {
+
+namespace {
+
+typedef BddManager::Bdd Bdd;
+typedef BddManager::Variable Variable;
+
+/**
+ * Boolean algebra of BDDs, for SymbolicExecutor.
+ */
+class BddAlgebra {
+	BddManager &manager_;
+
+public:
+	typedef Bdd Bit;
+
+	explicit
+	BddAlgebra(BddManager &manager): manager_(manager) {}
+
+	Bit zero() const { return BddManager::ZERO; }
+	Bit one() const { return BddManager::ONE; }
+	Bit bitNot(Bit a) { return manager_.bddNot(a); }
+	Bit bitAnd(Bit a, Bit b) { return manager_.bddAnd(a, b); }
+	Bit bitOr(Bit a, Bit b) { return manager_.bddOr(a, b); }
+	Bit bitXor(Bit a, Bit b) { return manager_.bddXor(a, b); }
+	Bit bitIte(Bit c, Bit a, Bit b) { return manager_.ite(c, a, b); }
+};
+
+/**
+ * Order of the BDD variables of the bits of the state.
+ *
+ * The bits of the values of cells and registers are interleaved by their
+ * significance, so that copying a value between any two of them, or comparing
+ * them, takes a BDD of size linear in the width. The variables of the values
+ * of a bit before and after a transition are adjacent.
+ */
+class VariableOrder {
+	std::vector<std::size_t> ranks_;
+
+public:
+	explicit
+	VariableOrder(const SymbolicLayout &layout): ranks_(layout.size()) {
+		auto valuesOffset = layout.valuesOffset();
+		auto valuesCount = (layout.size() - valuesOffset) / layout.width();
+		for (std::size_t bit = 0; bit < layout.size(); ++bit) {
+			if (bit < valuesOffset) {
+				ranks_[bit] = bit;
+			} else {
+				auto value = (bit - valuesOffset) / layout.width();
+				auto significance = (bit - valuesOffset) % layout.width();
+				ranks_[bit] = valuesOffset + significance * valuesCount + value;
+			}
+		}
+	}
+
+	Variable current(std::size_t bit) const { return static_cast<Variable>(2 * ranks_[bit]); }
+	Variable next(std::size_t bit) const { return static_cast<Variable>(2 * ranks_[bit] + 1); }
+};
+
+/**
+ * Transition relation of a transition of the program, kept as a conjunction:
+ * the guard on the current values of the bits, and for each bit the transition
+ * changes, the equivalence of its next value and its new value as a function of
+ * the current ones. Building the conjunction would take a BDD exponential in the
+ * number of bits copied, while its conjunction with a set of states is usually small.
+ */
+struct Relation {
+	Bdd guard;
+	std::vector<Bdd> updates;
+	/** Current variables of the bits the transition changes. */
+	Bdd changed;
+};
+
+} // anonymous namespace
+
+bool isInterestingStateSCReachableSymbolically(const Program &program, unsigned width, std::size_t maxNodesCount, bool &complete) {
+	complete = false;
+
+	SymbolicLayout layout(program, width);
+	BddManager manager(maxNodesCount);
+	BddAlgebra algebra(manager);
+	SymbolicExecutor<BddAlgebra> executor(layout, algebra);
+
+	VariableOrder order(layout);
+
+	std::vector<Bdd> state(layout.size());
+	for (std::size_t bit = 0; bit < layout.size(); ++bit) {
+		state[bit] = manager.variable(order.current(bit));
+	}
+
+	std::vector<Relation> relations;
+	Bdd escapes = BddManager::ZERO;
+
+	std::vector<Bdd> successor;
+	for (std::size_t thread = 0; thread < layout.census().threads().size(); ++thread) {
+		for (const Transition *transition : layout.census().threads()[thread]->transitions()) {
+			Bdd escape;
+			Bdd guard = executor.execute(thread, *transition, state, successor, escape);
+			escapes = manager.bddOr(escapes, escape);
+
+			/* The escaping executions are left out, so that all the states found are really reachable. */
+			guard = manager.bddAnd(guard, manager.bddNot(escape));
+			if (guard == BddManager::ZERO) {
+				continue;
+			}
+
+			Relation relation{guard, std::vector<Bdd>(), BddManager::ONE};
+			std::vector<Variable> changed;
+			for (std::size_t bit = 0; bit < layout.size(); ++bit) {
+				if (successor[bit] != state[bit]) {
+					relation.updates.push_back(manager.bddNot(manager.bddXor(manager.variable(order.next(bit)), successor[bit])));
+					changed.push_back(order.current(bit));
+				}
+			}
+			relation.changed = manager.cube(std::move(changed));
+			relations.push_back(std::move(relation));
+		}
+	}
+
+	if (!executor.isExact() || manager.exhausted()) {
+		return false;
+	}
+
+	std::vector<Variable> renaming(2 * layout.size());
+	for (std::size_t bit = 0; bit < layout.size(); ++bit) {
+		renaming[order.current(bit)] = order.current(bit);
+		renaming[order.next(bit)] = order.current(bit);
+	}
+
+	Bdd finalStates = executor.isFinal(state);
+
+	Bdd reached = BddManager::ONE;
+	for (std::size_t bit = layout.size(); bit-- > 0; ) {
+		reached = manager.bddAnd(manager.bddNot(state[bit]), reached);
+	}
+	Bdd frontier = reached;
+
+	for (std::size_t depth = 0; frontier != BddManager::ZERO; ++depth) {
+		if (manager.bddAnd(frontier, finalStates) != BddManager::ZERO) {
+			if (manager.exhausted()) {
+				return false;
+			}
+			complete = true;
+			Statistics::instance().addWitnessLength(depth);
+			return true;
+		}
+		if (manager.bddAnd(frontier, escapes) != BddManager::ZERO) {
+			/* Some successors of the states found are not encoded. */
+			return false;
+		}
+
+		Bdd image = BddManager::ZERO;
+		for (const auto &relation : relations) {
+			Bdd product = manager.bddAnd(frontier, relation.guard);
+			if (product == BddManager::ZERO) {
+				continue;
+			}
+			for (std::size_t i = 0; i + 1 < relation.updates.size(); ++i) {
+				product = manager.bddAnd(product, relation.updates[i]);
+			}
+			if (!relation.updates.empty()) {
+				product = manager.andExists(product, relation.updates.back(), relation.changed);
+			}
+			image = manager.bddOr(image, manager.rename(product, renaming));
+		}
+
+		frontier = manager.bddAnd(image, manager.bddNot(reached));
+		reached = manager.bddOr(reached, frontier);
+
+		if (manager.exhausted()) {
+			return false;
+		}
+	}
+
+	complete = true;
+	return false;
+}
+
+} // namespace trench
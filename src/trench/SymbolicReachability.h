@@ -0,0 +1,36 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <trench/config.h>
+
+#include <cstddef>
+
+namespace trench {
+
+class Program;
+
+/**
+ * Checks whether the interesting state of the program is reachable under SC
+ * using a symbolic breadth-first search: sets of states are represented by BDDs
+ * over the bits of SymbolicLayout, and the successors of a whole level are computed
+ * at once, separately for each transition of the program.
+ *
+ * \param[in]  program       Program.
+ * \param[in]  width         Number of bits in the values of memory cells and registers.
+ * \param[in]  maxNodesCount Number of BDD nodes after which the search gives up, zero if unlimited.
+ * \param[out] complete      False if the search has given up: it has run out of nodes,
+ *                           or the program cannot be encoded exactly with the given width.
+ *
+ * \return True if the interesting state is reachable, false if it is not or the search has given up.
+ */
+bool isInterestingStateSCReachableSymbolically(const Program &program, unsigned width, std::size_t maxNodesCount, bool &complete);
+
+} // namespace trench
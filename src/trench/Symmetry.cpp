@@ -0,0 +1,148 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#include "Symmetry.h"
+
+#include <cassert>
+
+#include "Census.h"
+#include "Instruction.h"
+#include "State.h"
+#include "Transition.h"
+
+namespace trench {
+
+namespace {
+
+bool equal(const Expression &a, const Expression &b) {
+	if (a.kind() != b.kind()) {
+		return false;
+	}
+	switch (a.kind()) {
+		case Expression::CONSTANT:
+			return a.as<Constant>()->value() == b.as<Constant>()->value();
+		case Expression::REGISTER:
+			/* Registers with the same name are the same object. */
+			return &a == &b;
+		case Expression::UNARY: {
+			auto ua = a.as<UnaryOperator>();
+			auto ub = b.as<UnaryOperator>();
+			return ua->kind() == ub->kind() && equal(*ua->operand(), *ub->operand());
+		}
+		case Expression::BINARY: {
+			auto ba = a.as<BinaryOperator>();
+			auto bb = b.as<BinaryOperator>();
+			return ba->kind() == bb->kind() && equal(*ba->left(), *bb->left()) && equal(*ba->right(), *bb->right());
+		}
+		case Expression::CAN_ACCESS_MEMORY:
+			return true;
+	}
+	assert(!"NEVER REACHED");
+	return false;
+}
+
+bool equal(const Instruction &a, const Instruction &b) {
+	if (a.mnemonic() != b.mnemonic()) {
+		return false;
+	}
+	switch (a.mnemonic()) {
+		case Instruction::READ: {
+			auto ra = a.as<Read>();
+			auto rb = b.as<Read>();
+			return ra->reg() == rb->reg() && ra->space() == rb->space() && equal(*ra->address(), *rb->address());
+		}
+		case Instruction::WRITE: {
+			auto wa = a.as<Write>();
+			auto wb = b.as<Write>();
+			return wa->space() == wb->space() && equal(*wa->value(), *wb->value()) && equal(*wa->address(), *wb->address());
+		}
+		case Instruction::LOCAL: {
+			auto la = a.as<Local>();
+			auto lb = b.as<Local>();
+			return la->reg() == lb->reg() && equal(*la->value(), *lb->value());
+		}
+		case Instruction::CONDITION:
+			return equal(*a.as<Condition>()->expression(), *b.as<Condition>()->expression());
+		case Instruction::ATOMIC: {
+			const auto &ia = a.as<Atomic>()->instructions();
+			const auto &ib = b.as<Atomic>()->instructions();
+			if (ia.size() != ib.size()) {
+				return false;
+			}
+			for (std::size_t i = 0; i < ia.size(); ++i) {
+				if (!equal(*ia[i], *ib[i])) {
+					return false;
+				}
+			}
+			return true;
+		}
+		case Instruction::MFENCE: /* FALLTHROUGH */
+		case Instruction::NOOP: /* FALLTHROUGH */
+		case Instruction::LOCK: /* FALLTHROUGH */
+		case Instruction::UNLOCK:
+			return true;
+	}
+	assert(!"NEVER REACHED");
+	return false;
+}
+
+bool areInterchangeable(const Census &census, std::size_t a, std::size_t b) {
+	const auto &statesA = census.states(a);
+	const auto &statesB = census.states(b);
+
+	if (statesA.size() != statesB.size() || census.registers(a) != census.registers(b)) {
+		return false;
+	}
+
+	for (std::size_t state = 0; state < statesA.size(); ++state) {
+		const auto &outA = statesA[state]->out();
+		const auto &outB = statesB[state]->out();
+
+		if (outA.size() != outB.size()) {
+			return false;
+		}
+		for (std::size_t i = 0; i < outA.size(); ++i) {
+			if (census.getId(outA[i]->to()) != census.getId(outB[i]->to()) ||
+			    !equal(*outA[i]->instruction(), *outB[i]->instruction())) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+} // anonymous namespace
+
+Symmetry computeSymmetry(const Census &census) {
+	Symmetry result;
+
+	std::vector<bool> assigned(census.threads().size());
+	for (std::size_t thread = 0; thread < census.threads().size(); ++thread) {
+		if (assigned[thread]) {
+			continue;
+		}
+
+		std::vector<std::size_t> threads(1, thread);
+		for (std::size_t other = thread + 1; other < census.threads().size(); ++other) {
+			if (!assigned[other] && areInterchangeable(census, thread, other)) {
+				threads.push_back(other);
+				assigned[other] = true;
+			}
+		}
+
+		if (threads.size() > 1) {
+			result.addClass(std::move(threads));
+		}
+	}
+
+	return result;
+}
+
+} // namespace trench
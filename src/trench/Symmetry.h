@@ -0,0 +1,44 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE JUICE-WARE LICENSE" (Revision 42):
+ * <derevenetc@cs.uni-kl.de> wrote this file. As long as you retain this notice
+ * you can do whatever you want with this stuff. If we meet some day, and you
+ * think this stuff is worth it, you can buy me a glass of juice in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <trench/config.h>
+
+#include <vector>
+
+namespace trench {
+
+class Census;
+
+/**
+ * Classes of interchangeable threads.
+ *
+ * Threads of a class are copies of the same automaton: they have the same
+ * registers, and their control states with the same ids have the same
+ * outgoing transitions, leading to the states with the same ids. Any
+ * permutation of such threads maps executions of the program to executions.
+ *
+ * Threads are identified by their ids in a Census.
+ */
+class Symmetry {
+	std::vector<std::vector<std::size_t>> classes_;
+
+public:
+	/**
+	 * \return Classes of at least two interchangeable threads, each sorted by thread id.
+	 */
+	const std::vector<std::vector<std::size_t>> &classes() const { return classes_; }
+
+	void addClass(std::vector<std::size_t> threads) { classes_.push_back(std::move(threads)); }
+};
+
+Symmetry computeSymmetry(const Census &census);
+
+} // namespace trench
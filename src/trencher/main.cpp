@@ -8,9 +8,12 @@
  */
 
 #include <cassert>
+#include <cerrno>
 #include <chrono>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <stdexcept>
 
 #include <trench/AutomatonPrinting.h>
@@ -41,7 +44,135 @@ void help() {
 	<< "  -por   Enable partial order reduction." << std::endl
 	<< "  -npor  Disable partial order reduction." << std::endl
 	<< "  -live  Enable live variables optimization." << std::endl
-	<< "  -nlive Disable live variables optimization." << std::endl;
+	<< "  -nlive Disable live variables optimization." << std::endl
+	<< "  -j N   Explore the state space of the program using N threads with -r and" << std::endl
+	<< "         -trf (-f and -ftrf check the attacks in parallel instead)." << std::endl
+	<< "  -bitstate MB" << std::endl
+	<< "         Use bitstate hashing with a bit array of MB megabytes: -r and -trf" << std::endl
+	<< "         may miss attacks, -f and -ftrf look for attacks this way first." << std::endl
+	<< "  -hc    Keep only 64-bit fingerprints of visited states (hash compaction)." << std::endl
+	<< "  -nhc   Keep visited states in full." << std::endl
+	<< "  -collapse" << std::endl
+	<< "         Share equal components of visited states (collapse compression," << std::endl
+	<< "         sequential search only)." << std::endl
+	<< "  -ncollapse" << std::endl
+	<< "         Disable collapse compression." << std::endl
+	<< "  -inplace" << std::endl
+	<< "         Search changing a single state in place and undoing the changes" << std::endl
+	<< "         on backtracking (default)." << std::endl
+	<< "  -ninplace" << std::endl
+	<< "         Search keeping a copy of each state on the current path." << std::endl
+	<< "  -ample" << std::endl
+	<< "         Explore only the transitions of one thread whenever they are" << std::endl
+	<< "         independent from the rest of the program (ample sets)." << std::endl
+	<< "  -nample" << std::endl
+	<< "         Disable ample set reduction (default)." << std::endl
+	<< "  -sleep" << std::endl
+	<< "         Do not re-explore interleavings of independent transitions" << std::endl
+	<< "         (sleep sets, sequential exact search only)." << std::endl
+	<< "  -nsleep" << std::endl
+	<< "         Disable sleep sets (default)." << std::endl
+	<< "  -symmetry" << std::endl
+	<< "         Identify states differing only by a permutation of threads" << std::endl
+	<< "         with identical code (default)." << std::endl
+	<< "  -nsymmetry" << std::endl
+	<< "         Disable symmetry reduction." << std::endl
+	<< "  -dpor" << std::endl
+	<< "         Check attacks on programs without loops using the stateless" << std::endl
+	<< "         search with dynamic partial order reduction (default)." << std::endl
+	<< "  -ndpor" << std::endl
+	<< "         Always use the search keeping the visited states." << std::endl
+	<< "  -dporlimit N" << std::endl
+	<< "         Give up the stateless search in favour of the search keeping" << std::endl
+	<< "         the visited states after visiting N states (default 4096," << std::endl
+	<< "         0 means no limit)." << std::endl
+	<< "  -backward" << std::endl
+	<< "         Before searching for an attack, try to prove it infeasible by an" << std::endl
+	<< "         approximate search backwards from its completion (default)." << std::endl
+	<< "  -nbackward" << std::endl
+	<< "         Disable the backward search." << std::endl
+	<< "  -backwardlimit N" << std::endl
+	<< "         Give up the backward search after computing N partial states" << std::endl
+	<< "         (default 4096, 0 means no limit)." << std::endl
+	<< "  -share Explore the states of the program before any attack starts once" << std::endl
+	<< "         and start the search for each attack from them (default)." << std::endl
+	<< "  -nshare" << std::endl
+	<< "         Explore these states anew for each attack." << std::endl
+	<< "  -sharelimit N" << std::endl
+	<< "         Do not share these states if there are more than N of them" << std::endl
+	<< "         (default 1048576, 0 means no limit)." << std::endl
+	<< "  -joint Find all the feasible attacks for -f and -ftrf by a single" << std::endl
+	<< "         exhaustive search recording the attack made. The search is" << std::endl
+	<< "         depth-first and sequential and keeps the visited states in full:" << std::endl
+	<< "         -j, -mem, -hc, -collapse, -bitstate, -sleep and the search order" << std::endl
+	<< "         options do not apply to it." << std::endl
+	<< "  -njoint" << std::endl
+	<< "         Search for each attack separately (default)." << std::endl
+	<< "  -coi   Remove from the program instrumented for an attack what cannot" << std::endl
+	<< "         influence its completion (default)." << std::endl
+	<< "  -ncoi  Do not remove it." << std::endl
+	<< "  -bfs   Search breadth-first, finding shortest paths to attacks" << std::endl
+	<< "         (with -j N, each level is expanded by N threads)." << std::endl
+	<< "  -dfs, -nbfs" << std::endl
+	<< "         Search depth-first (default)." << std::endl
+	<< "  -greedy" << std::endl
+	<< "         Search first from the states where the threads are fewest" << std::endl
+	<< "         transitions away from completing an attack (sequential search)." << std::endl
+	<< "  -astar Like -greedy, but accounting for the length of the path so far," << std::endl
+	<< "         finding shortest paths to attacks (A*, sequential search)." << std::endl
+	<< "  -mem MB" << std::endl
+	<< "         Write the visited states out to temporary files when they take" << std::endl
+	<< "         more than about MB megabytes of memory (sequential breadth-first" << std::endl
+	<< "         search, 0 means no limit, default)." << std::endl
+	<< "  -bdd   Search for attacks symbolically, representing sets of states" << std::endl
+	<< "         by BDDs, if the explicit search visits too many states, and" << std::endl
+	<< "         fall back to -explicit when this fails." << std::endl
+	<< "  -bmc   Search for attacks by bounded model checking first, and fall" << std::endl
+	<< "         back to -explicit when no attack is found." << std::endl
+	<< "  -bmcdepth N" << std::endl
+	<< "         Search for attacks of at most N steps by bounded model checking" << std::endl
+	<< "         (default 16)." << std::endl
+	<< "  -explicit" << std::endl
+	<< "         Search for attacks enumerating states one by one (default)." << std::endl
+	<< "  -width N" << std::endl
+	<< "         Encode values of memory cells and registers by N bits (default 8)." << std::endl
+	<< "  -bddnodes N" << std::endl
+	<< "         Give up the symbolic search after making N BDD nodes" << std::endl
+	<< "         (default 1048576, 0 means no limit)." << std::endl
+	<< "  -bddthreshold N" << std::endl
+	<< "         With -bdd, search for an attack symbolically only after the" << std::endl
+	<< "         explicit search has visited N states (default 65536, 0 means" << std::endl
+	<< "         at once)." << std::endl;
+}
+
+/**
+ * Parses the argument of a numeric option.
+ *
+ * \param argc Number of command-line arguments.
+ * \param argv Command-line arguments.
+ * \param i    Index of the option, advanced to its argument.
+ * \param what Description of the value for error messages.
+ * \param min  Least value allowed.
+ * \param max  Greatest value allowed.
+ *
+ * \return The value of the argument.
+ */
+std::size_t parseNumber(int argc, char **argv, int &i, const char *what,
+                        std::size_t min = 0, std::size_t max = std::numeric_limits<std::size_t>::max()) {
+	std::string option = argv[i];
+	if (i + 1 >= argc) {
+		throw std::runtime_error("option requires an argument: " + option);
+	}
+	const char *string = argv[++i];
+
+	/* strtoul() accepts leading blanks and signs, wrapping negative numbers around. */
+	char *end;
+	errno = 0;
+	unsigned long value = std::strtoul(string, &end, 10);
+	if (*string < '0' || *string > '9' || *end != '\0' || errno == ERANGE || value < min || value > max) {
+		throw std::runtime_error("invalid " + std::string(what) + " for " + option + ": " + string);
+	}
+	return static_cast<std::size_t>(value);
 }
 
 int main(int argc, char **argv) {
@@ -92,6 +223,84 @@ int main(int argc, char **argv) {
 				trench::Configuration::instance().setLivenessOptimization(true);
 			} else if (arg == "-nlive") {
 				trench::Configuration::instance().setLivenessOptimization(false);
+			} else if (arg == "-j") {
+				trench::Configuration::instance().setWorkersCount(parseNumber(argc, argv, i, "number of threads", 1));
+			} else if (arg == "-hc") {
+				trench::Configuration::instance().setHashCompaction(true);
+			} else if (arg == "-nhc") {
+				trench::Configuration::instance().setHashCompaction(false);
+			} else if (arg == "-collapse") {
+				trench::Configuration::instance().setCollapseCompression(true);
+			} else if (arg == "-ncollapse") {
+				trench::Configuration::instance().setCollapseCompression(false);
+			} else if (arg == "-inplace") {
+				trench::Configuration::instance().setInPlaceSearch(true);
+			} else if (arg == "-ninplace") {
+				trench::Configuration::instance().setInPlaceSearch(false);
+			} else if (arg == "-ample") {
+				trench::Configuration::instance().setAmplePartialOrderReduction(true);
+			} else if (arg == "-nample") {
+				trench::Configuration::instance().setAmplePartialOrderReduction(false);
+			} else if (arg == "-sleep") {
+				trench::Configuration::instance().setSleepSets(true);
+			} else if (arg == "-nsleep") {
+				trench::Configuration::instance().setSleepSets(false);
+			} else if (arg == "-symmetry") {
+				trench::Configuration::instance().setSymmetryReduction(true);
+			} else if (arg == "-nsymmetry") {
+				trench::Configuration::instance().setSymmetryReduction(false);
+			} else if (arg == "-dpor") {
+				trench::Configuration::instance().setStatelessSearch(true);
+			} else if (arg == "-ndpor") {
+				trench::Configuration::instance().setStatelessSearch(false);
+			} else if (arg == "-backward") {
+				trench::Configuration::instance().setBackwardSearch(true);
+			} else if (arg == "-nbackward") {
+				trench::Configuration::instance().setBackwardSearch(false);
+			} else if (arg == "-backwardlimit") {
+				trench::Configuration::instance().setBackwardSearchLimit(parseNumber(argc, argv, i, "number of states"));
+			} else if (arg == "-share") {
+				trench::Configuration::instance().setOriginalStatesSharing(true);
+			} else if (arg == "-nshare") {
+				trench::Configuration::instance().setOriginalStatesSharing(false);
+			} else if (arg == "-sharelimit") {
+				trench::Configuration::instance().setOriginalStatesLimit(parseNumber(argc, argv, i, "number of states"));
+			} else if (arg == "-joint") {
+				trench::Configuration::instance().setJointAttackSearch(true);
+			} else if (arg == "-njoint") {
+				trench::Configuration::instance().setJointAttackSearch(false);
+			} else if (arg == "-coi") {
+				trench::Configuration::instance().setConeOfInfluence(true);
+			} else if (arg == "-ncoi") {
+				trench::Configuration::instance().setConeOfInfluence(false);
+			} else if (arg == "-bdd") {
+				trench::Configuration::instance().setBackend(trench::Configuration::BDD);
+			} else if (arg == "-bmc") {
+				trench::Configuration::instance().setBackend(trench::Configuration::BMC);
+			} else if (arg == "-bmcdepth") {
+				trench::Configuration::instance().setBmcDepth(parseNumber(argc, argv, i, "number of steps"));
+			} else if (arg == "-explicit") {
+				trench::Configuration::instance().setBackend(trench::Configuration::EXPLICIT);
+			} else if (arg == "-width") {
+				trench::Configuration::instance().setSymbolicWidth(static_cast<unsigned>(parseNumber(argc, argv, i, "width", 1, 32)));
+			} else if (arg == "-bddnodes") {
+				trench::Configuration::instance().setBddNodesLimit(parseNumber(argc, argv, i, "number of nodes"));
+			} else if (arg == "-bddthreshold") {
+				trench::Configuration::instance().setSymbolicThreshold(parseNumber(argc, argv, i, "number of states"));
+			} else if (arg == "-bfs") {
+				trench::Configuration::instance().setSearchOrder(trench::Configuration::BREADTH_FIRST);
+			} else if (arg == "-nbfs" || arg == "-dfs") {
+				trench::Configuration::instance().setSearchOrder(trench::Configuration::DEPTH_FIRST);
+			} else if (arg == "-greedy") {
+				trench::Configuration::instance().setSearchOrder(trench::Configuration::GREEDY);
+			} else if (arg == "-astar") {
+				trench::Configuration::instance().setSearchOrder(trench::Configuration::A_STAR);
+			} else if (arg == "-dporlimit") {
+				trench::Configuration::instance().setStatelessSearchLimit(parseNumber(argc, argv, i, "number of states"));
+			} else if (arg == "-mem") {
+				trench::Configuration::instance().setMemoryLimit(parseNumber(argc, argv, i, "memory limit", 0, std::numeric_limits<std::size_t>::max() >> 20) << 20);
+			} else if (arg == "-bitstate") {
+				trench::Configuration::instance().setBitstateMemory(parseNumber(argc, argv, i, "bit array size", 0, std::numeric_limits<std::size_t>::max() >> 20) << 20);
 			} else if (arg.size() >= 1 && arg[0] == '-') {
 				throw std::runtime_error("unknown option: " + arg);
 			} else {
@@ -118,7 +327,11 @@ int main(int argc, char **argv) {
 
 				switch (action) {
 					case ROBUSTNESS: {
-						bool feasible = trench::isAttackFeasible(program, false);
+						trench::AttackCheckOptions options;
+						options.bitstateMemory = trench::Configuration::instance().bitstateMemory();
+						options.exact = false;
+
+						bool feasible = trench::isAttackFeasible(program, false, options);
 						if (!benchmarking) {
 							if (feasible) {
 								std::cout << "Program IS NOT robust." << std::endl;
@@ -140,7 +353,11 @@ int main(int argc, char **argv) {
 						break;
 					}
 					case TRIANGULAR_RACE_FREEDOM: {
-						bool feasible = trench::isAttackFeasible(program, true);
+						trench::AttackCheckOptions options;
+						options.bitstateMemory = trench::Configuration::instance().bitstateMemory();
+						options.exact = false;
+
+						bool feasible = trench::isAttackFeasible(program, true, options);
 						if (!benchmarking) {
 							if (feasible) {
 								std::cout << "Program IS NOT free from triangular data races." << std::endl;